@@ -0,0 +1,84 @@
+import argparse
+import os
+import struct
+
+class ScenarioToBinary:
+    """
+    Converts the text .collisions and .route files of a scenario into one binary .scenario file.
+    The layout has to match src/scenario_file.h.
+    """
+
+    magic = b"DPSC"
+    version = 1
+
+    flag_int16_points = 1 << 0
+
+    # magic, version, flags, reserved, bounds_min[3], bounds_max[3], num_points, num_route_points,
+    # points_offset, route_offset
+    header_format = "<4sIII3i3iQQQQ"
+
+    def __init__(self, collisions_file, route_file):
+        self.collisions = self.read_points(collisions_file)
+        self.route = self.read_points(route_file)
+
+    @staticmethod
+    def read_points(path) -> list:
+        # Same rules as the text parsers: skip empty lines and comments, stop at "end"
+        points = []
+        with open(path, "r") as file:
+            for line in file:
+                line = line.rstrip("\r\n")
+                if not line or line[0] == " " or line[0] == "#":
+                    continue
+                if line == "end":
+                    break
+                values = line.split(" ")
+                points.append(tuple(int(float(v)) for v in values[:3]))
+        return points
+
+    def bounds(self):
+        if not self.collisions:
+            return (0, 0, 0), (0, 0, 0)
+        bounds_min = tuple(min(p[i] for p in self.collisions) for i in range(3))
+        bounds_max = tuple(max(p[i] for p in self.collisions) for i in range(3))
+        return bounds_min, bounds_max
+
+    def write(self, output_file):
+        bounds_min, bounds_max = self.bounds()
+        flags = 0
+        point_format = "<3i"
+        if all(-32768 <= v <= 32767 for p in self.collisions for v in p):
+            flags |= self.flag_int16_points
+            point_format = "<3h"
+
+        points = b"".join(struct.pack(point_format, *p) for p in self.collisions)
+        route = b"".join(struct.pack("<3i", *p) for p in self.route)
+
+        points_offset = struct.calcsize(self.header_format)
+        route_offset = points_offset + len(points)
+
+        header = struct.pack(self.header_format, self.magic, self.version, flags, 0, *bounds_min, *bounds_max,
+                             len(self.collisions), len(self.route), points_offset, route_offset)
+        with open(output_file, "wb") as file:
+            file.write(header)
+            file.write(points)
+            file.write(route)
+
+        print(f"Wrote {len(self.collisions)} obstacles and {len(self.route)} route points to {output_file}")
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert text scenario files into a binary scenario file')
+    parser.add_argument('scenario_dir', help='Scenario directory containing <name>.collisions and <name>.route')
+    parser.add_argument('--output', help='Output file (default: <scenario_dir>/<name>.scenario)')
+    args = parser.parse_args()
+
+    name = os.path.basename(os.path.normpath(args.scenario_dir))
+    collisions_file = os.path.join(args.scenario_dir, f"{name}.collisions")
+    route_file = os.path.join(args.scenario_dir, f"{name}.route")
+    output_file = args.output if args.output else os.path.join(args.scenario_dir, f"{name}.scenario")
+
+    converter = ScenarioToBinary(collisions_file, route_file)
+    converter.write(output_file)
+
+if __name__ == "__main__":
+    main()
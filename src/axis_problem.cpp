@@ -0,0 +1,217 @@
+#include "axis_problem.h"
+
+dynamic_programming::AxisProblem::AxisProblem(const Range& positions, const Range& velocities, const StateSpace& goal_space, const int axis, const unit stretch_factor, const float delta_time)
+  : m_grids{ positions, velocities },
+  m_lengths{ positions.length(), velocities.length() },
+  m_goal_begin{ goal_space.begin[axis], goal_space.begin[axis + 3] },
+  m_goal_end{ goal_space.end[axis], goal_space.end[axis + 3] },
+  m_stretch_factor(stretch_factor),
+  m_delta_time(delta_time)
+{
+  if (positions.get_step() != STEP_SIZE || velocities.get_step() != STEP_SIZE)
+    throw std::invalid_argument("the integral search of the axis problem requires a step of STEP_SIZE");
+  m_steps_to_goal.assign(num_states(), 0);
+  m_lower_bound.assign(num_states(), 0.f);
+}
+
+size_t dynamic_programming::AxisProblem::fill_terminal_costs()
+{
+  m_V.assign(1, std::vector<float>(num_states()));
+  m_u_opt.assign(1, std::vector<int>(num_states(), -1));
+  size_t count = 0;
+  for (size_t c = 0; c < m_lengths[0]; c++)
+    for (size_t v = 0; v < m_lengths[1]; v++)
+    {
+      bool contains = in_goal(m_grids[0].value_at(c), m_grids[1].value_at(v));
+      m_V[0][c * m_lengths[1] + v] = contains ? 0.f : std::numeric_limits<float>::max();
+      if (contains)
+        count++;
+    }
+  return count;
+}
+
+dynamic_programming::AxisProblem::StageStats dynamic_programming::AxisProblem::calculate_stage(const long steps_to_go, const unit max_input)
+{
+  if (steps_to_go < 1 || (size_t)steps_to_go != m_V.size())
+    throw std::logic_error("Stage " + std::to_string(steps_to_go) + " of the axis problem can't be calculated before the previous one");
+  const std::vector<float>& next_values = m_V[steps_to_go - 1];
+  const std::vector<int>& previous_policy = m_u_opt[steps_to_go - 1];
+  std::vector<float> values(num_states());
+  std::vector<int> policy(num_states());
+  const unit components[NUM_COMPONENTS]{ -max_input, 0, max_input };
+
+  StageStats stats;
+  for (size_t i_v = 0; i_v < m_lengths[1]; i_v++)
+  {
+    unit v = m_grids[1].value_at(i_v);
+    unit new_vs[NUM_COMPONENTS]{};
+    int i_new_vs[NUM_COMPONENTS]{};
+    for (int k = 0; k < NUM_COMPONENTS; k++)
+    {
+      unit acceleration = components[k];
+      if constexpr (DRAG_FORCE_COEFFICIENT != 0)
+        acceleration += -DRAG_FORCE_COEFFICIENT * v;
+      new_vs[k] = v + acceleration * m_delta_time;
+    }
+    m_grids[1].search_integral<STEP_SIZE>(new_vs, i_new_vs, NUM_COMPONENTS);
+
+    for (size_t i_c = 0; i_c < m_lengths[0]; i_c++)
+    {
+      unit c = m_grids[0].value_at(i_c);
+      unit new_cs[NUM_COMPONENTS]{};
+      int i_new_cs[NUM_COMPONENTS]{};
+      for (int k = 0; k < NUM_COMPONENTS; k++)
+        new_cs[k] = c + new_vs[k] * m_delta_time;
+      m_grids[0].search_integral<STEP_SIZE>(new_cs, i_new_cs, NUM_COMPONENTS);
+
+      // Strict comparison in input order like the stage kernel, so that ties go to the first component
+      float min_cost_to_go = std::numeric_limits<float>::max();
+      int argmin_cost_to_go = -1;
+      bool any_valid = false;
+      for (int k = 0; k < NUM_COMPONENTS; k++)
+      {
+        if (i_new_vs[k] == -1 || i_new_cs[k] == -1)
+          continue;
+        any_valid = true;
+        // Approximation of the 6D running cost, which is 0 only if every axis is in the goal and isn't a sum of per-axis terms.
+        // An axis in its goal doesn't pay for its state, but the input is always paid, so that it doesn't wander inside the goal.
+        int squared_norm = components[k] * components[k];
+        if (!in_goal(new_cs[k], new_vs[k]))
+          squared_norm += new_cs[k] * new_cs[k] + new_vs[k] * new_vs[k];
+        float running_cost = (float)squared_norm * m_delta_time;
+        float cost_to_go = running_cost + next_values[i_new_cs[k] * m_lengths[1] + i_new_vs[k]];
+        if (cost_to_go < min_cost_to_go)
+        {
+          min_cost_to_go = cost_to_go;
+          argmin_cost_to_go = k;
+        }
+      }
+
+      const size_t i_state = i_c * m_lengths[1] + i_v;
+      values[i_state] = min_cost_to_go;
+      policy[i_state] = argmin_cost_to_go;
+      if (any_valid)
+        stats.evaluated_states++;
+
+      float previous_value = next_values[i_state];
+      bool finite = min_cost_to_go < std::numeric_limits<float>::max();
+      if (finite)
+        stats.finite_states++;
+      if (finite != (previous_value < std::numeric_limits<float>::max()))
+        stats.max_value_change = std::numeric_limits<float>::infinity();
+      else if (finite)
+        stats.max_value_change = std::max(stats.max_value_change, std::abs(min_cost_to_go - previous_value) / std::max(1.f, std::abs(previous_value)));
+      // The terminal stage has no policy
+      if (steps_to_go > 1 && argmin_cost_to_go != previous_policy[i_state])
+        stats.policy_changes++;
+    }
+  }
+
+  m_V.push_back(std::move(values));
+  m_u_opt.push_back(std::move(policy));
+  return stats;
+}
+
+size_t dynamic_programming::AxisProblem::calculate_feasible_states(const std::vector<unit>& components, const std::vector<unit>& disturbances)
+{
+  // Robust backward reachability of the goal interval. Every layer adds the states whose successors are all in earlier layers.
+  size_t count = 0;
+  for (size_t i_c = 0; i_c < m_lengths[0]; i_c++)
+    for (size_t i_v = 0; i_v < m_lengths[1]; i_v++)
+    {
+      bool contains = in_goal(m_grids[0].value_at(i_c), m_grids[1].value_at(i_v));
+      m_steps_to_goal[i_c * m_lengths[1] + i_v] = contains ? 0 : UNREACHABLE;
+      if (contains)
+        count++;
+    }
+
+  bool changed = true;
+  for (int layer = 1; changed; layer++)
+  {
+    changed = false;
+    for (size_t i_c = 0; i_c < m_lengths[0]; i_c++)
+      for (size_t i_v = 0; i_v < m_lengths[1]; i_v++)
+      {
+        if (m_steps_to_goal[i_c * m_lengths[1] + i_v] != UNREACHABLE)
+          continue;
+        unit c = m_grids[0].value_at(i_c);
+        unit v = m_grids[1].value_at(i_v);
+        for (unit component : components)
+        {
+          bool reaches = true;
+          for (unit disturbance : disturbances)
+          {
+            unit acceleration = component + disturbance;
+            if constexpr (DRAG_FORCE_COEFFICIENT != 0)
+              acceleration += -DRAG_FORCE_COEFFICIENT * v;
+            unit new_v = v + acceleration * m_delta_time;
+            unit new_c = c + new_v * m_delta_time;
+            int i_new_c = m_grids[0].search_integral<STEP_SIZE>(new_c);
+            int i_new_v = m_grids[1].search_integral<STEP_SIZE>(new_v);
+            if (i_new_c == -1 || i_new_v == -1 || m_steps_to_goal[i_new_c * m_lengths[1] + i_new_v] >= layer)
+            {
+              reaches = false;
+              break;
+            }
+          }
+          if (reaches)
+          {
+            m_steps_to_goal[i_c * m_lengths[1] + i_v] = layer;
+            count++;
+            changed = true;
+            break;
+          }
+        }
+      }
+  }
+  return count;
+}
+
+void dynamic_programming::AxisProblem::calculate_cost_lower_bound(const std::vector<unit>& components)
+{
+  // Shortest paths to the goal interval by relaxing every state until no cost is lowered
+  for (size_t i_c = 0; i_c < m_lengths[0]; i_c++)
+    for (size_t i_v = 0; i_v < m_lengths[1]; i_v++)
+      m_lower_bound[i_c * m_lengths[1] + i_v] = in_goal(m_grids[0].value_at(i_c), m_grids[1].value_at(i_v)) ? 0.f : std::numeric_limits<float>::max();
+
+  bool changed = true;
+  while (changed)
+  {
+    changed = false;
+    for (size_t i_c = 0; i_c < m_lengths[0]; i_c++)
+      for (size_t i_v = 0; i_v < m_lengths[1]; i_v++)
+      {
+        unit c = m_grids[0].value_at(i_c);
+        unit v = m_grids[1].value_at(i_v);
+        float& bound = m_lower_bound[i_c * m_lengths[1] + i_v];
+        for (unit component : components)
+        {
+          unit acceleration = component;
+          if constexpr (DRAG_FORCE_COEFFICIENT != 0)
+            acceleration += -DRAG_FORCE_COEFFICIENT * v;
+          unit new_v = v + acceleration * m_delta_time;
+          unit new_c = c + new_v * m_delta_time;
+          int i_new_c = m_grids[0].search_integral<STEP_SIZE>(new_c);
+          int i_new_v = m_grids[1].search_integral<STEP_SIZE>(new_v);
+          if (i_new_c == -1 || i_new_v == -1)
+            continue;
+          float running_cost = in_goal(new_c, new_v) ? 0.f
+            : (float)(component * component + new_c * new_c + new_v * new_v) * m_delta_time;
+          float cost = running_cost + m_lower_bound[i_new_c * m_lengths[1] + i_new_v];
+          if (cost < bound)
+          {
+            bound = cost;
+            changed = true;
+          }
+        }
+      }
+  }
+}
+
+bool dynamic_programming::AxisProblem::in_goal(const unit position, const unit velocity) const
+{
+  unit stretched_position = position * m_stretch_factor;
+  unit stretched_velocity = velocity * m_stretch_factor;
+  return m_goal_begin[0] <= stretched_position && m_goal_end[0] >= stretched_position
+    && m_goal_begin[1] <= stretched_velocity && m_goal_end[1] >= stretched_velocity;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "consts.h"
+#include "range.h"
+#include "state_space.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Finite horizon problem of one axis, whose state is its (position, velocity) pair. Without obstacles and disturbances
+  /// the dynamics of the axes don't interact and the inputs are the product of per-axis components, but the 6D running cost
+  /// isn't a sum of per-axis terms. Three of these problems therefore only approximate the 6D problem. The running cost of
+  /// an axis differs from its share of the 6D cost in two ways:
+  /// - The squared input component is always paid, while the 6D cost is 0 once the successor is in the goal.
+  /// - The squared position and velocity are only paid outside the goal interval of the axis, while the 6D cost pays them
+  ///   for every axis until all axes are in the goal.
+  /// Which states have a finite value in a stage is exact. Only the choice between inputs that reach the goal may differ.
+  /// Values and policies are stored for every number of steps to go. 0 is the terminal stage.
+  /// </summary>
+  class AxisProblem
+  {
+  public:
+    /// <summary>
+    /// Number of input components per axis: -max, 0 and max, in the order of create_inputs
+    /// </summary>
+    static const int NUM_COMPONENTS = 3;
+
+    /// <summary>
+    /// Steps to the goal of a state that can't reach it
+    /// </summary>
+    static const int UNREACHABLE = std::numeric_limits<int>::max();
+
+    struct StageStats
+    {
+      size_t finite_states = 0;
+      /// <summary>
+      /// States with at least one valid successor
+      /// </summary>
+      size_t evaluated_states = 0;
+      float max_value_change = 0.f;
+      size_t policy_changes = 0;
+    };
+
+    /// <summary>
+    /// The grids are the stretched ones of the DP. The goal of the axis is taken from the unstretched goal space of the DP.
+    /// </summary>
+    AxisProblem(const Range& positions, const Range& velocities, const StateSpace& goal_space, const int axis, const unit stretch_factor, const float delta_time);
+
+    /// <summary>
+    /// Fills the terminal stage and returns the number of states in the goal
+    /// </summary>
+    size_t fill_terminal_costs();
+
+    /// <summary>
+    /// Calculates the stage with the given number of steps to go from the one with one step less.
+    /// The input components are -max_input, 0 and max_input.
+    /// </summary>
+    StageStats calculate_stage(const long steps_to_go, const unit max_input);
+
+    float value(const long steps_to_go, const int i_position, const int i_velocity) const
+    {
+      return m_V[steps_to_go][i_position * m_lengths[1] + i_velocity];
+    }
+
+    /// <summary>
+    /// Index of the optimal input component or -1 if no input reaches the goal
+    /// </summary>
+    int policy(const long steps_to_go, const int i_position, const int i_velocity) const
+    {
+      return m_u_opt[steps_to_go][i_position * m_lengths[1] + i_velocity];
+    }
+
+    /// <summary>
+    /// Calculates the minimum number of steps in which the goal interval of the axis can be reached without leaving the grid,
+    /// with some of the input components, whatever the disturbance components are. A 6D state has infinite cost in all
+    /// stages with fewer steps to go than one of its axes needs. Returns the number of states that can reach the goal.
+    /// </summary>
+    size_t calculate_feasible_states(const std::vector<unit>& components, const std::vector<unit>& disturbances);
+
+    /// <summary>
+    /// Every state needs 0 steps until calculate_feasible_states is called
+    /// </summary>
+    int steps_to_goal(const size_t i_position, const size_t i_velocity) const
+    {
+      return m_steps_to_goal[i_position * m_lengths[1] + i_velocity];
+    }
+
+    bool is_feasible(const size_t i_position, const size_t i_velocity) const
+    {
+      return steps_to_goal(i_position, i_velocity) != UNREACHABLE;
+    }
+
+    /// <summary>
+    /// Calculates the cheapest cost of reaching the goal interval of the axis in any number of steps without disturbances,
+    /// where nothing is paid once the axis is in its goal. The 6D running cost is at least the sum of these per-axis
+    /// costs and disturbances and obstacles can only raise it, so the sum is a lower bound of the 6D cost-to-go.
+    /// </summary>
+    void calculate_cost_lower_bound(const std::vector<unit>& components);
+
+    /// <summary>
+    /// 0 until calculate_cost_lower_bound is called
+    /// </summary>
+    float cost_lower_bound(const size_t i_position, const size_t i_velocity) const
+    {
+      return m_lower_bound[i_position * m_lengths[1] + i_velocity];
+    }
+
+    bool is_calculated(const long steps_to_go) const
+    {
+      return steps_to_go >= 0 && (size_t)steps_to_go < m_V.size();
+    }
+
+    size_t num_states() const
+    {
+      return m_lengths[0] * m_lengths[1];
+    }
+
+  private:
+    bool in_goal(const unit position, const unit velocity) const;
+
+    Range m_grids[2];
+    size_t m_lengths[2];
+    unit m_goal_begin[2];
+    unit m_goal_end[2];
+    const unit m_stretch_factor;
+    const float m_delta_time;
+    std::vector<std::vector<float>> m_V;
+    std::vector<std::vector<int>> m_u_opt;
+    std::vector<int> m_steps_to_goal;
+    std::vector<float> m_lower_bound;
+  };
+}
@@ -24,6 +24,11 @@ void dynamic_programming::CollisionCloud::add_collision(point3 point)
   m_collisions.push_back(point);
 }
 
+void dynamic_programming::CollisionCloud::add_collisions(const std::vector<point3>& points)
+{
+  m_collisions.insert(m_collisions.end(), points.begin(), points.end());
+}
+
 void dynamic_programming::CollisionCloud::reset_will_collide_array()
 {
   for (int8_t* it = m_will_collide.origin(); it < (m_will_collide.origin() + m_will_collide.num_elements()); it++)
@@ -34,11 +39,24 @@ void dynamic_programming::CollisionCloud::reset_will_collide_array()
 
 bool dynamic_programming::CollisionCloud::will_collide(const point3& i_old_c, const point3& i_new_c)
 {
+  Stats stats;
+  return will_collide(i_old_c, i_new_c, stats);
+}
+
+bool dynamic_programming::CollisionCloud::will_collide(const point3& i_old_c, const point3& i_new_c, Stats& stats)
+{
+  stats.checks++;
   int8_t& will_collide = m_will_collide[i_old_c.x()][i_old_c.y()][i_old_c.z()][i_new_c.x()][i_new_c.y()][i_new_c.z()];
   if (will_collide == 0)
+  {
+    stats.memo_hits++;
     return false;
+  }
   else if (will_collide == 1)
+  {
+    stats.memo_hits++;
     return true;
+  }
 
   auto x = boost::minmax(i_old_c.x(), i_new_c.x());
   auto y = boost::minmax(i_old_c.y(), i_new_c.y());
@@ -48,6 +66,7 @@ bool dynamic_programming::CollisionCloud::will_collide(const point3& i_old_c, co
 
   for (const point3& collision : m_collisions)
   {
+    stats.obstacles_scanned++;
     if (collision.get<0>() < x.get<0>() - m_min_dist * 2 || collision.get<0>() > x.get<1>() + m_min_dist * 2
       || collision.get<1>() < y.get<0>() - m_min_dist * 2 || collision.get<1>() > y.get<1>() + m_min_dist * 2
       || collision.get<2>() < z.get<0>() - m_min_dist * 2 || collision.get<2>() > z.get<1>() + m_min_dist * 2)
@@ -96,26 +115,26 @@ bool dynamic_programming::CollisionCloud::will_collide(const point3& i_old_c, co
   return false;
 }
 
-void dynamic_programming::CollisionCloud::add_collisions_from_file(const std::string path, std::function<point3(const unit3&)> converter)
+void dynamic_programming::CollisionCloud::import_will_collide(const CollisionCloud& other, const point3& offset)
 {
-  std::ifstream file(path);
-  if (file.is_open())
+  const size_t* shape = other.m_will_collide.shape();
+  const size_t* own_shape = m_will_collide.shape();
+  const int o[3]{ offset.x(), offset.y(), offset.z() };
+  for (int i = 0; i < 3; i++)
   {
-    std::string line;
-    unit3 collision{};
-    while (std::getline(file, line))
-    {
-      if (line.empty() || line.at(0) == ' ' || line.at(0) == '#')
-        continue;
-      if (line.compare("end") == 0)
-        break;
-      std::string::size_type index = line.find(" ");
-      collision.x = (unit)std::stof(line.substr(0, index));
-      line = line.substr(index + 1);
-      index = line.find(" ");
-      collision.y = (unit)std::stof(line.substr(0, index));
-      collision.z = (unit)std::stof(line.substr(index + 1));
-      add_collision(converter(collision));
-    }
+    if (o[i] < 0 || o[i] + shape[i] > own_shape[i])
+      throw std::invalid_argument("Imported collision memo must lie inside the collision memo");
   }
+
+  for (size_t a0 = 0; a0 < shape[0]; a0++)
+    for (size_t a1 = 0; a1 < shape[1]; a1++)
+      for (size_t a2 = 0; a2 < shape[2]; a2++)
+        for (size_t b0 = 0; b0 < shape[3]; b0++)
+          for (size_t b1 = 0; b1 < shape[4]; b1++)
+          {
+            // The last dimension is contiguous
+            const int8_t* from = &other.m_will_collide[a0][a1][a2][b0][b1][0];
+            int8_t* to = &m_will_collide[a0 + o[0]][a1 + o[1]][a2 + o[2]][b0 + o[0]][b1 + o[1]][o[2]];
+            std::copy(from, from + shape[5], to);
+          }
 }
@@ -2,8 +2,8 @@
 
 #include "consts.h"
 #include <algorithm>
-#include <fstream>
-#include <functional>
+#include <stdexcept>
+#include <vector>
 
 #pragma warning(push, 0)
 #include <boost/multi_array.hpp>
@@ -29,6 +29,24 @@ namespace dynamic_programming
     typedef boost::multi_array<int8_t, 6> will_collide_array;
     typedef bg::model::d3::point_xyz<int> point3;
 
+    /// <summary>
+    /// Counters of will_collide. Every thread uses its own instance.
+    /// </summary>
+    struct Stats
+    {
+      size_t checks = 0;
+      size_t memo_hits = 0;
+      size_t obstacles_scanned = 0;
+
+      Stats& operator+=(const Stats& rhs)
+      {
+        checks += rhs.checks;
+        memo_hits += rhs.memo_hits;
+        obstacles_scanned += rhs.obstacles_scanned;
+        return *this;
+      }
+    };
+
     CollisionCloud(const size_t lengths[3], unit step_size);
     CollisionCloud(const size_t& lx, const size_t& ly, const size_t& lz, unit step_size);
     CollisionCloud(const CollisionCloud& rhs);
@@ -37,12 +55,20 @@ namespace dynamic_programming
 
     void add_collision(point3 point);
 
-    void add_collisions_from_file(const std::string path, std::function<point3(const unit3&)> converter);
+    void add_collisions(const std::vector<point3>& points);
 
     bool will_collide(const point3& i_old_c, const point3& i_new_c);
 
+    bool will_collide(const point3& i_old_c, const point3& i_new_c, Stats& stats);
+
     std::vector<point3>& get_collisions() { return m_collisions; }
 
+    /// <summary>
+    /// Copies the memo of another cloud whose cells are this cloud's cells shifted by offset.
+    /// Only valid if the other cloud contains every obstacle that is close enough to collide with its transitions.
+    /// </summary>
+    void import_will_collide(const CollisionCloud& other, const point3& offset);
+
   private:
     std::vector<point3> m_collisions;
     will_collide_array m_will_collide;
@@ -1,4 +1,5 @@
 #include "config.h"
+#include "consts.h"
 
 void dynamic_programming::Config::load_from_file(const std::string& file)
 {
@@ -100,30 +101,42 @@ void dynamic_programming::Config::save_to_file(const std::string& file)
 
 bool dynamic_programming::Config::validate_data()
 {
-  // Check if all required keys are set
-  // ROUTE_FILE and COLLISION_CLOUD_FILE are required
-  if (!is_set(Key::ROUTE_FILE) || !is_set(Key::COLLISION_CLOUD_FILE))
+  // Check if BENCHMARK is a known mode
+  std::string benchmark = get(Key::BENCHMARK);
+  if (!benchmark.empty() && benchmark != "micro" && benchmark != "scenarios" && benchmark != "scaling")
   {
-    BOOST_LOG_TRIVIAL(error) << "Route file or collision cloud file not set";
+    BOOST_LOG_TRIVIAL(error) << "BENCHMARK must be empty, micro, scenarios or scaling";
     return false;
   }
-  // Check if files exist
-  if (!std::filesystem::exists(get(Key::ROUTE_FILE)) || !std::filesystem::exists(get(Key::COLLISION_CLOUD_FILE)))
-  {
-    BOOST_LOG_TRIVIAL(error) << "Route file or collision cloud file does not exist";
-    return false;
-  }
-  // Check if files are regular files
-  if (!std::filesystem::is_regular_file(get(Key::ROUTE_FILE)) || !std::filesystem::is_regular_file(get(Key::COLLISION_CLOUD_FILE)))
+
+  // Benchmarks bring their own routes and collision clouds
+  if (benchmark.empty())
   {
-    BOOST_LOG_TRIVIAL(error) << "Route file or collision cloud file is not a regular file";
-    return false;
+    // Check if all required keys are set
+    // ROUTE_FILE and COLLISION_CLOUD_FILE are required
+    if (!is_set(Key::ROUTE_FILE) || !is_set(Key::COLLISION_CLOUD_FILE))
+    {
+      BOOST_LOG_TRIVIAL(error) << "Route file or collision cloud file not set";
+      return false;
+    }
+    // Check if files exist
+    if (!std::filesystem::exists(get(Key::ROUTE_FILE)) || !std::filesystem::exists(get(Key::COLLISION_CLOUD_FILE)))
+    {
+      BOOST_LOG_TRIVIAL(error) << "Route file or collision cloud file does not exist";
+      return false;
+    }
+    // Check if files are regular files
+    if (!std::filesystem::is_regular_file(get(Key::ROUTE_FILE)) || !std::filesystem::is_regular_file(get(Key::COLLISION_CLOUD_FILE)))
+    {
+      BOOST_LOG_TRIVIAL(error) << "Route file or collision cloud file is not a regular file";
+      return false;
+    }
   }
   
   // Check other keys
 
-  // Check if NUMBER_OF_STAGES is an int
-  if (!is_int(get(Key::NUMBER_OF_STAGES), "NUMBER_OF_STAGES"))
+  // Check if NUMBER_OF_STAGES and MAX_NUMBER_OF_STAGES are ints
+  if (!is_int(get(Key::NUMBER_OF_STAGES), "NUMBER_OF_STAGES") || !is_int(get(Key::MAX_NUMBER_OF_STAGES), "MAX_NUMBER_OF_STAGES"))
   {
     return false;
   }
@@ -134,10 +147,36 @@ bool dynamic_programming::Config::validate_data()
     return false;
   }
 
-  // Check if DISTURBANCE_ON is a bool
-  if (get(Key::DISTURBANCE_ON) != "true" && get(Key::DISTURBANCE_ON) != "false")
+#if _INTEGER_COSTS == 1
+  // Collision costs aren't integers
+  if (get<float>(Key::COLLISION_COST_FACTOR) != 0.f)
+  {
+    BOOST_LOG_TRIVIAL(error) << "COLLISION_COST_FACTOR must be 0 with integer costs";
+    return false;
+  }
+#endif
+
+  // Check if COLLISION_COST_RADIUS is an int
+  if (!is_int(get(Key::COLLISION_COST_RADIUS), "COLLISION_COST_RADIUS"))
+  {
+    return false;
+  }
+
+  // Check if the flags are bools
+  if (!is_bool(get(Key::DISTURBANCE_ON), "DISTURBANCE_ON")
+    || !is_bool(get(Key::APPLY_DISTURBANCE), "APPLY_DISTURBANCE")
+    || !is_bool(get(Key::ENABLE_NORM_FIX_POINT), "ENABLE_NORM_FIX_POINT")
+    || !is_bool(get(Key::ENABLE_INITIAL_FIX_POINT), "ENABLE_INITIAL_FIX_POINT")
+    || !is_bool(get(Key::USE_SINGLE_STAGE_CONTROLLER), "USE_SINGLE_STAGE_CONTROLLER")
+    || !is_bool(get(Key::TRACE), "TRACE")
+    || !is_bool(get(Key::PERF_COUNTERS), "PERF_COUNTERS")
+    || !is_bool(get(Key::WARM_START_RETRIES), "WARM_START_RETRIES")
+    || !is_bool(get(Key::ENABLE_VALUE_FIX_POINT), "ENABLE_VALUE_FIX_POINT")
+    || !is_bool(get(Key::ENABLE_POLICY_FIX_POINT), "ENABLE_POLICY_FIX_POINT")
+    || !is_bool(get(Key::SEPARABLE_LEGS), "SEPARABLE_LEGS")
+    || !is_bool(get(Key::PRUNE_INFEASIBLE_STATES), "PRUNE_INFEASIBLE_STATES")
+    || !is_bool(get(Key::ENABLE_COST_BOUND), "ENABLE_COST_BOUND"))
   {
-    BOOST_LOG_TRIVIAL(error) << "DISTURBANCE_ON is not a bool";
     return false;
   }
 
@@ -147,9 +186,143 @@ bool dynamic_programming::Config::validate_data()
     return false;
   }
 
+  // Check if the benchmark parameters are ints
+  if (!is_int(get(Key::BENCHMARK_GRID_LENGTH), "BENCHMARK_GRID_LENGTH") || !is_int(get(Key::BENCHMARK_REPETITIONS), "BENCHMARK_REPETITIONS")
+    || !is_int(get(Key::BENCHMARK_MAX_THREADS), "BENCHMARK_MAX_THREADS"))
+  {
+    return false;
+  }
+
+  // Check if BENCHMARK_BASELINE_MODE is known
+  std::string baseline_mode = get(Key::BENCHMARK_BASELINE_MODE);
+  if (baseline_mode != "compare" && baseline_mode != "write" && baseline_mode != "skip")
+  {
+    BOOST_LOG_TRIVIAL(error) << "BENCHMARK_BASELINE_MODE must be compare, write or skip";
+    return false;
+  }
+
+  // Check if BENCHMARK_TOLERANCE is a float
+  if (!is_float(get(Key::BENCHMARK_TOLERANCE), "BENCHMARK_TOLERANCE"))
+  {
+    return false;
+  }
+
+  // Check if RANDOM_SEED is an int
+  if (!is_int(get(Key::RANDOM_SEED), "RANDOM_SEED"))
+  {
+    return false;
+  }
+
+  // Check if RESOURCE_SAMPLE_INTERVAL_MS is a positive int
+  if (!is_int(get(Key::RESOURCE_SAMPLE_INTERVAL_MS), "RESOURCE_SAMPLE_INTERVAL_MS"))
+  {
+    return false;
+  }
+  if (get<int>(Key::RESOURCE_SAMPLE_INTERVAL_MS) <= 0)
+  {
+    BOOST_LOG_TRIVIAL(error) << "RESOURCE_SAMPLE_INTERVAL_MS must be greater than 0";
+    return false;
+  }
+
+  // Check if NUM_THREADS is a positive int
+  if (!is_int(get(Key::NUM_THREADS), "NUM_THREADS"))
+  {
+    return false;
+  }
+  if (get<int>(Key::NUM_THREADS) <= 0)
+  {
+    BOOST_LOG_TRIVIAL(error) << "NUM_THREADS must be greater than 0";
+    return false;
+  }
+
+  // Check if MEMORY_LIMIT_MB is a non-negative int
+  if (!is_int(get(Key::MEMORY_LIMIT_MB), "MEMORY_LIMIT_MB"))
+  {
+    return false;
+  }
+  if (get<int>(Key::MEMORY_LIMIT_MB) < 0)
+  {
+    BOOST_LOG_TRIVIAL(error) << "MEMORY_LIMIT_MB must not be negative";
+    return false;
+  }
+
+  // Check if the fix point tolerances are non-negative floats
+  if (!is_float(get(Key::VALUE_FIX_POINT_TOLERANCE), "VALUE_FIX_POINT_TOLERANCE") || !is_float(get(Key::POLICY_FIX_POINT_TOLERANCE), "POLICY_FIX_POINT_TOLERANCE"))
+  {
+    return false;
+  }
+  if (get<float>(Key::VALUE_FIX_POINT_TOLERANCE) < 0.f || get<float>(Key::POLICY_FIX_POINT_TOLERANCE) < 0.f)
+  {
+    BOOST_LOG_TRIVIAL(error) << "VALUE_FIX_POINT_TOLERANCE and POLICY_FIX_POINT_TOLERANCE must not be negative";
+    return false;
+  }
+
+  // Check if SOLVER is known. Only Jacobi calculates a controller for every stage.
+  std::string solver = get(Key::SOLVER);
+  if (solver != "jacobi" && solver != "gauss_seidel" && solver != "policy_iteration")
+  {
+    BOOST_LOG_TRIVIAL(error) << "SOLVER must be jacobi, gauss_seidel or policy_iteration";
+    return false;
+  }
+  if (solver != "jacobi" && get<bool>(Key::USE_SINGLE_STAGE_CONTROLLER))
+  {
+    BOOST_LOG_TRIVIAL(error) << "SOLVER " << solver << " can't be combined with USE_SINGLE_STAGE_CONTROLLER";
+    return false;
+  }
+
+  // The stationary controller is applied to every state of the flight, so it can't lose the values of states the cost bound skips
+  if (get<bool>(Key::ENABLE_COST_BOUND) && !get<bool>(Key::USE_SINGLE_STAGE_CONTROLLER))
+  {
+    BOOST_LOG_TRIVIAL(error) << "ENABLE_COST_BOUND requires USE_SINGLE_STAGE_CONTROLLER";
+    return false;
+  }
+
+  // Check if STAGE_TELEMETRY is a known sink
+  std::string stage_telemetry = get(Key::STAGE_TELEMETRY);
+  if (stage_telemetry != "none" && stage_telemetry != "jsonl" && stage_telemetry != "csv" && stage_telemetry != "both")
+  {
+    BOOST_LOG_TRIVIAL(error) << "STAGE_TELEMETRY must be none, jsonl, csv or both";
+    return false;
+  }
+
   return true;
 }
 
+dynamic_programming::Settings dynamic_programming::Config::get_settings() const
+{
+  Settings settings{};
+  settings.number_of_stages = get<int>(Key::NUMBER_OF_STAGES);
+  settings.collision_cost_factor = get<float>(Key::COLLISION_COST_FACTOR);
+  settings.collision_cost_radius = get<int>(Key::COLLISION_COST_RADIUS);
+  settings.disturbance_on = get<bool>(Key::DISTURBANCE_ON);
+  settings.apply_disturbance = get<bool>(Key::APPLY_DISTURBANCE);
+  settings.disturbance_change_factor = get<int>(Key::DISTURBANCE_CHANGE_FACTOR);
+  settings.enable_norm_fix_point = get<bool>(Key::ENABLE_NORM_FIX_POINT);
+  settings.enable_initial_fix_point = get<bool>(Key::ENABLE_INITIAL_FIX_POINT);
+  settings.use_single_stage_controller = get<bool>(Key::USE_SINGLE_STAGE_CONTROLLER);
+  settings.random_seed = get<int>(Key::RANDOM_SEED);
+  settings.perf_counters = get<bool>(Key::PERF_COUNTERS);
+  settings.num_threads = get<int>(Key::NUM_THREADS);
+  settings.memory_limit_mb = get<int>(Key::MEMORY_LIMIT_MB);
+  settings.warm_start_retries = get<bool>(Key::WARM_START_RETRIES);
+  settings.max_number_of_stages = get<int>(Key::MAX_NUMBER_OF_STAGES);
+  settings.enable_value_fix_point = get<bool>(Key::ENABLE_VALUE_FIX_POINT);
+  settings.value_fix_point_tolerance = get<float>(Key::VALUE_FIX_POINT_TOLERANCE);
+  settings.enable_policy_fix_point = get<bool>(Key::ENABLE_POLICY_FIX_POINT);
+  settings.policy_fix_point_tolerance = get<float>(Key::POLICY_FIX_POINT_TOLERANCE);
+  std::string solver = get(Key::SOLVER);
+  if (solver == "gauss_seidel")
+    settings.solver = Settings::GAUSS_SEIDEL;
+  else if (solver == "policy_iteration")
+    settings.solver = Settings::POLICY_ITERATION;
+  else
+    settings.solver = Settings::JACOBI;
+  settings.separable_legs = get<bool>(Key::SEPARABLE_LEGS);
+  settings.prune_infeasible_states = get<bool>(Key::PRUNE_INFEASIBLE_STATES);
+  settings.enable_cost_bound = get<bool>(Key::ENABLE_COST_BOUND);
+  return settings;
+}
+
 bool dynamic_programming::Config::is_int(const std::string& s, const std::string& key)
 {
   try
@@ -166,6 +339,7 @@ bool dynamic_programming::Config::is_int(const std::string& s, const std::string
     BOOST_LOG_TRIVIAL(error) << key << " is not an int";
     return false;
   }
+  return true;
 }
 
 bool dynamic_programming::Config::is_float(const std::string& s, const std::string& key)
@@ -184,4 +358,15 @@ bool dynamic_programming::Config::is_float(const std::string& s, const std::stri
     BOOST_LOG_TRIVIAL(error) << key << " is not a float";
     return false;
   }
+  return true;
+}
+
+bool dynamic_programming::Config::is_bool(const std::string& s, const std::string& key)
+{
+  if (s != "true" && s != "false")
+  {
+    BOOST_LOG_TRIVIAL(error) << key << " is not a bool";
+    return false;
+  }
+  return true;
 }
@@ -2,12 +2,91 @@
 #include <string>
 #include <fstream>
 #include <map>
-#include <map>
 #include <boost/log/trivial.hpp>
 #include <filesystem>
 
 namespace dynamic_programming
 {
+  /// <summary>
+  /// Typed, immutable snapshot of the config values that are read while running.
+  /// It is created once by Config::get_settings() after validation, so that no strings are parsed per step.
+  /// </summary>
+  struct Settings
+  {
+    /// <summary>
+    /// JACOBI calculates one stage per step to go from the previous one. GAUSS_SEIDEL iterates a single stationary
+    /// value function in place and uses updated values within the same sweep. POLICY_ITERATION alternates such a sweep
+    /// with an evaluation of the policy it found.
+    /// </summary>
+    enum Solver
+    {
+      JACOBI,
+      GAUSS_SEIDEL,
+      POLICY_ITERATION
+    };
+
+    int number_of_stages;
+    float collision_cost_factor;
+    int collision_cost_radius;
+    bool disturbance_on;
+    bool apply_disturbance;
+    int disturbance_change_factor;
+    bool enable_norm_fix_point;
+    bool enable_initial_fix_point;
+    bool use_single_stage_controller;
+    /// <summary>
+    /// Seed of the disturbances. 0 seeds from the current time.
+    /// </summary>
+    int random_seed;
+    /// <summary>
+    /// Read hardware performance counters around every worker chunk of a stage
+    /// </summary>
+    bool perf_counters;
+    /// <summary>
+    /// Number of worker threads of a stage. The stage is split along the first velocity axis.
+    /// </summary>
+    int num_threads;
+    /// <summary>
+    /// Upper bound of the estimated memory footprint of a DP in MB. 0 disables the check.
+    /// </summary>
+    int memory_limit_mb;
+    /// <summary>
+    /// Start a retry on an extended state space from the value function of the previous calculation
+    /// </summary>
+    bool warm_start_retries;
+    /// <summary>
+    /// Number of stages the horizon may grow to if the initial region isn't covered after number_of_stages
+    /// </summary>
+    int max_number_of_stages;
+    /// <summary>
+    /// Stop the sweep once no value changes by more than value_fix_point_tolerance relative to max(1, |previous value|)
+    /// and no state changes between finite and infinite cost. With a tolerance of 0 the value function is a fix point.
+    /// </summary>
+    bool enable_value_fix_point;
+    float value_fix_point_tolerance;
+    /// <summary>
+    /// Stop the sweep once at most the fraction policy_fix_point_tolerance of the states changes its optimal input
+    /// </summary>
+    bool enable_policy_fix_point;
+    float policy_fix_point_tolerance;
+    Solver solver;
+    /// <summary>
+    /// Solve legs without obstacles and disturbances as three decoupled (position, velocity) problems. Their summed cost
+    /// only approximates the 6D running cost, so the composed controller isn't necessarily the optimal 6D one.
+    /// </summary>
+    bool separable_legs;
+    /// <summary>
+    /// Skip the states from which the goal of one of the axes can't be reached without leaving the state space
+    /// </summary>
+    bool prune_infeasible_states;
+    /// <summary>
+    /// Skip the states whose lower bound of the cost-to-go exceeds the best value of the initial state so far.
+    /// Their values are lost for other start states, so it requires use_single_stage_controller. It is only exact as long as
+    /// the value of the initial state doesn't grow with more stages, which disturbances can break.
+    /// </summary>
+    bool enable_cost_bound;
+  };
+
   // Singleton
   class Config
   {
@@ -32,12 +111,39 @@ namespace dynamic_programming
       ROUTE_FILE,
       NUMBER_OF_STAGES,
       COLLISION_COST_FACTOR,
+      COLLISION_COST_RADIUS,
       DISTURBANCE_ON,
       APPLY_DISTURBANCE,
       DISTURBANCE_CHANGE_FACTOR,
       ENABLE_NORM_FIX_POINT,
       ENABLE_INITIAL_FIX_POINT,
-      USE_SINGLE_STAGE_CONTROLLER
+      USE_SINGLE_STAGE_CONTROLLER,
+      RANDOM_SEED,
+      RESOURCE_SAMPLE_INTERVAL_MS,
+      STAGE_TELEMETRY,
+      TRACE,
+      PERF_COUNTERS,
+      NUM_THREADS,
+      MEMORY_LIMIT_MB,
+      WARM_START_RETRIES,
+      MAX_NUMBER_OF_STAGES,
+      ENABLE_VALUE_FIX_POINT,
+      VALUE_FIX_POINT_TOLERANCE,
+      ENABLE_POLICY_FIX_POINT,
+      POLICY_FIX_POINT_TOLERANCE,
+      SOLVER,
+      SEPARABLE_LEGS,
+      PRUNE_INFEASIBLE_STATES,
+      ENABLE_COST_BOUND,
+      BENCHMARK,
+      BENCHMARK_GRID_LENGTH,
+      BENCHMARK_REPETITIONS,
+      BENCHMARK_SCENARIOS,
+      BENCHMARK_CONFIGS,
+      BENCHMARK_BASELINE,
+      BENCHMARK_BASELINE_MODE,
+      BENCHMARK_TOLERANCE,
+      BENCHMARK_MAX_THREADS
     };
 
     void load_from_file(const std::string& file);
@@ -85,6 +191,11 @@ namespace dynamic_programming
 
     bool validate_data();
 
+    /// <summary>
+    /// Parses the current values into a settings snapshot. Call after validate_data().
+    /// </summary>
+    Settings get_settings() const;
+
   private:
     Config()
     {
@@ -102,6 +213,9 @@ namespace dynamic_programming
       m_key_names[COLLISION_COST_FACTOR] = "collision_cost_factor";
       m_default_values[COLLISION_COST_FACTOR] = "0.0";
 
+      m_key_names[COLLISION_COST_RADIUS] = "collision_cost_radius";
+      m_default_values[COLLISION_COST_RADIUS] = "10";
+
       m_key_names[DISTURBANCE_ON] = "disturbance_on";
       m_default_values[DISTURBANCE_ON] = "true";
 
@@ -119,10 +233,88 @@ namespace dynamic_programming
 
       m_key_names[USE_SINGLE_STAGE_CONTROLLER] = "use_single_stage_controller";
       m_default_values[USE_SINGLE_STAGE_CONTROLLER] = "false";
+
+      m_key_names[RANDOM_SEED] = "random_seed";
+      m_default_values[RANDOM_SEED] = "0";
+
+      m_key_names[RESOURCE_SAMPLE_INTERVAL_MS] = "resource_sample_interval_ms";
+      m_default_values[RESOURCE_SAMPLE_INTERVAL_MS] = "100";
+
+      m_key_names[STAGE_TELEMETRY] = "stage_telemetry";
+      m_default_values[STAGE_TELEMETRY] = "csv";
+
+      m_key_names[TRACE] = "trace";
+      m_default_values[TRACE] = "false";
+
+      m_key_names[PERF_COUNTERS] = "perf_counters";
+      m_default_values[PERF_COUNTERS] = "false";
+
+      m_key_names[NUM_THREADS] = "num_threads";
+      m_default_values[NUM_THREADS] = "16";
+
+      m_key_names[MEMORY_LIMIT_MB] = "memory_limit_mb";
+      m_default_values[MEMORY_LIMIT_MB] = "0";
+
+      m_key_names[WARM_START_RETRIES] = "warm_start_retries";
+      m_default_values[WARM_START_RETRIES] = "true";
+
+      m_key_names[MAX_NUMBER_OF_STAGES] = "max_number_of_stages";
+      m_default_values[MAX_NUMBER_OF_STAGES] = "60";
+
+      m_key_names[ENABLE_VALUE_FIX_POINT] = "enable_value_fix_point";
+      m_default_values[ENABLE_VALUE_FIX_POINT] = "false";
+
+      m_key_names[VALUE_FIX_POINT_TOLERANCE] = "value_fix_point_tolerance";
+      m_default_values[VALUE_FIX_POINT_TOLERANCE] = "0.0";
+
+      m_key_names[ENABLE_POLICY_FIX_POINT] = "enable_policy_fix_point";
+      m_default_values[ENABLE_POLICY_FIX_POINT] = "false";
+
+      m_key_names[POLICY_FIX_POINT_TOLERANCE] = "policy_fix_point_tolerance";
+      m_default_values[POLICY_FIX_POINT_TOLERANCE] = "0.0";
+
+      m_key_names[SOLVER] = "solver";
+      m_default_values[SOLVER] = "jacobi";
+
+      m_key_names[SEPARABLE_LEGS] = "separable_legs";
+      m_default_values[SEPARABLE_LEGS] = "false";
+
+      m_key_names[PRUNE_INFEASIBLE_STATES] = "prune_infeasible_states";
+      m_default_values[PRUNE_INFEASIBLE_STATES] = "true";
+
+      m_key_names[ENABLE_COST_BOUND] = "enable_cost_bound";
+      m_default_values[ENABLE_COST_BOUND] = "false";
+
+      m_key_names[BENCHMARK] = "benchmark";
+
+      m_key_names[BENCHMARK_GRID_LENGTH] = "benchmark_grid_length";
+      m_default_values[BENCHMARK_GRID_LENGTH] = "11";
+
+      m_key_names[BENCHMARK_REPETITIONS] = "benchmark_repetitions";
+      m_default_values[BENCHMARK_REPETITIONS] = "10";
+
+      m_key_names[BENCHMARK_SCENARIOS] = "benchmark_scenarios";
+      m_default_values[BENCHMARK_SCENARIOS] = "simple,wall,yard,labyrinth,industrial,streets,large_distance,random";
+
+      m_key_names[BENCHMARK_CONFIGS] = "benchmark_configs";
+      m_default_values[BENCHMARK_CONFIGS] = "no_disturbance,disturbance";
+
+      m_key_names[BENCHMARK_BASELINE] = "benchmark_baseline";
+      m_default_values[BENCHMARK_BASELINE] = "scenarios/benchmark_baseline.csv";
+
+      m_key_names[BENCHMARK_BASELINE_MODE] = "benchmark_baseline_mode";
+      m_default_values[BENCHMARK_BASELINE_MODE] = "compare";
+
+      m_key_names[BENCHMARK_TOLERANCE] = "benchmark_tolerance";
+      m_default_values[BENCHMARK_TOLERANCE] = "0.2";
+
+      m_key_names[BENCHMARK_MAX_THREADS] = "benchmark_max_threads";
+      m_default_values[BENCHMARK_MAX_THREADS] = "16";
     }
 
     bool is_int(const std::string& s, const std::string& key);
     bool is_float(const std::string& s, const std::string& key);
+    bool is_bool(const std::string& s, const std::string& key);
 
     /// <summary>
     /// Map of key names
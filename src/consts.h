@@ -1,11 +1,16 @@
 #pragma once
 
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <stdexcept>
 #include <boost/log/trivial.hpp>
 
 #define _DISTURBANCES 1
+// Set to 1 for exact integer costs, as the ReleaseIntegerCosts configuration does. Only valid without collision costs, which are fractional.
+#ifndef _INTEGER_COSTS
+#define _INTEGER_COSTS 0
+#endif
 
 namespace dynamic_programming {
 
@@ -124,6 +129,31 @@ namespace dynamic_programming {
 
   const float R = 1;
 
+  /// <summary>
+  /// Type of the values of the DP. Without collision costs every running cost is an integer, so the values can be summed
+  /// exactly and ties are broken deterministically. COST_INF is the value of states that can't reach the goal.
+  /// </summary>
+#if _INTEGER_COSTS == 1
+  typedef uint32_t cost_t;
+#else
+  typedef float cost_t;
+#endif
+
+  const cost_t COST_INF = std::numeric_limits<cost_t>::max();
+
+  /// <summary>
+  /// Sum of two costs that saturates at COST_INF. Floats already saturate, because the running costs are too small to change max.
+  /// </summary>
+  inline cost_t add_costs(const cost_t a, const cost_t b)
+  {
+#if _INTEGER_COSTS == 1
+    cost_t sum = a + b;
+    return sum < a ? COST_INF : sum;
+#else
+    return a + b;
+#endif
+  }
+
   const size_t NUM_INPUTS = 27;
 
   extern unit3 INPUTS_FINE[NUM_INPUTS];
@@ -1,8 +1,12 @@
 #include "disturbance_controller.h"
 
-dynamic_programming::DisturbanceController::DisturbanceController()
+dynamic_programming::DisturbanceController::DisturbanceController(const Settings& settings)
+  : m_settings(settings)
 {
-  std::srand((unsigned)std::time(NULL));
+  if (m_settings.random_seed != 0)
+    std::srand((unsigned)m_settings.random_seed);
+  else
+    std::srand((unsigned)std::time(NULL));
 }
 
 dynamic_programming::DisturbanceController::~DisturbanceController()
@@ -11,13 +15,12 @@ dynamic_programming::DisturbanceController::~DisturbanceController()
 
 const dynamic_programming::unit3& dynamic_programming::DisturbanceController::get_next_disturbance()
 {
-  Config& config = Config::get_instance();
-  if (!config.get<bool>(Config::Key::DISTURBANCE_ON) || !config.get<bool>(Config::Key::APPLY_DISTURBANCE))
+  if (!m_settings.disturbance_on || !m_settings.apply_disturbance)
   {
     return DISTURBANCES[0];
   }
 
-  int factor = config.get<int>(Config::Key::DISTURBANCE_CHANGE_FACTOR);
+  int factor = m_settings.disturbance_change_factor;
   int will_change = std::rand() % factor;
   int index = m_last_index;
   if (will_change < m_turns_since_last_change)
@@ -9,12 +9,13 @@ namespace dynamic_programming
   class DisturbanceController
   {
   public:
-    DisturbanceController();
+    DisturbanceController(const Settings& settings);
     ~DisturbanceController();
 
     const unit3& get_next_disturbance();
 
   private:
+    const Settings m_settings;
     int m_last_index = 0;
     int m_turns_since_last_change = 0;
     bool m_applyDisturbance = false;
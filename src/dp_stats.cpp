@@ -1,5 +1,27 @@
 #include "dp_stats.h"
 
+static const double MB = 1024. * 1024.;
+
+dynamic_programming::DpStats::DpStats(const std::string& directory_path, const std::chrono::milliseconds& sample_interval)
+  : m_directory_path(directory_path), m_sampler(sample_interval)
+{
+  m_file.open(directory_path + "dp_stats.txt");
+  m_phases_file.open(directory_path + "dp_phases.csv");
+  m_phases_file << "dp,phase,stage,duration_ms,rss_mb,peak_rss_mb,user_cpu_ms,sys_cpu_ms,voluntary_context_switches,involuntary_context_switches" << std::endl;
+  m_samples_file.open(directory_path + "resource_samples.csv");
+  m_samples_file << "time_ms,phase,stage,rss_mb,peak_rss_mb,user_cpu_ms,sys_cpu_ms,voluntary_context_switches,involuntary_context_switches" << std::endl;
+  m_sampler.start();
+}
+
+dynamic_programming::DpStats::~DpStats()
+{
+  m_sampler.stop();
+  write_samples();
+  m_file.close();
+  m_phases_file.close();
+  m_samples_file.close();
+}
+
 void dynamic_programming::DpStats::dp_started(const DpStartedEvent& event)
 {
   if (!event.retry)
@@ -7,21 +29,25 @@ void dynamic_programming::DpStats::dp_started(const DpStartedEvent& event)
     m_file << "##################################################" << std::endl;
     m_file << "DP started" << std::endl;
     m_file << "num_states=" << event.num_states << std::endl;
+    m_file << "num_stages=" << event.num_stages << std::endl;
+    m_file << "estimated_memory_mb=" << event.estimated_bytes / MB << std::endl;
   }
   else
   {
     m_file << "DP started (retry)" << std::endl;
     m_file << "num_states=" << event.num_states << std::endl;
+    m_file << "num_stages=" << event.num_stages << std::endl;
+    m_file << "estimated_memory_mb=" << event.estimated_bytes / MB << std::endl;
   }
-  // Start new thread
-  m_end_thread = false;
-  m_thread = std::thread(&DpStats::resource_usage, this);
 }
 
 void dynamic_programming::DpStats::dp_finished(const DpFinishedEvent& event)
 {
-  m_end_thread = true;
-  m_thread.join();
+  finish_phase();
+  m_phase = "idle";
+  m_stage = -1;
+  m_sampler.set_tag(m_phase, m_stage);
+  ResourceUsage usage = get_resource_usage() - m_dp_begin_usage;
 
   m_file << "DP finished" << std::endl;
   m_file << "total_duration_s=" << event.total_duration.count() << std::endl;
@@ -30,33 +56,75 @@ void dynamic_programming::DpStats::dp_finished(const DpFinishedEvent& event)
   m_file << "first_stage_duration_s=" << std::chrono::duration_cast<std::chrono::seconds>(event.first_stage_duration).count() << std::endl;
   m_file << "avg_stage_duration_ms=" << event.avg_stage_duration.count() << std::endl;
   m_file << "avg_stage_duration_s=" << std::chrono::duration_cast<std::chrono::seconds>(event.avg_stage_duration).count() << std::endl;
+  m_file << "num_stages=" << event.num_stages << std::endl;
+  m_file << "finite_states=" << event.finite_states << std::endl;
+
+  // Resource usage of this DP including reinitialize
+  size_t rss_max = 0;
+  size_t rss_sum = 0;
+  size_t rss_count = 0;
+  for (const ResourceSampler::Sample& sample : write_samples())
+  {
+    if (sample.phase == "idle")
+      continue;
+    rss_max = std::max(rss_max, sample.usage.rss);
+    rss_sum += sample.usage.rss;
+    rss_count++;
+  }
+  m_file << "peak_rss_b=" << m_dp_peak_rss << std::endl;
+  m_file << "peak_rss_mb=" << (size_t)(m_dp_peak_rss / MB) << std::endl;
+  m_file << "max_sampled_rss_mb=" << (size_t)(rss_max / MB) << std::endl;
+  m_file << "avg_sampled_rss_mb=" << (rss_count > 0 ? (size_t)(rss_sum / rss_count / MB) : 0) << std::endl;
+  m_file << "num_samples=" << rss_count << std::endl;
+  m_file << "user_cpu_ms=" << usage.user_cpu_us / 1000 << std::endl;
+  m_file << "sys_cpu_ms=" << usage.sys_cpu_us / 1000 << std::endl;
+  m_file << "voluntary_context_switches=" << usage.voluntary_context_switches << std::endl;
+  m_file << "involuntary_context_switches=" << usage.involuntary_context_switches << std::endl;
 }
 
-void dynamic_programming::DpStats::resource_usage()
+void dynamic_programming::DpStats::dp_phase_started(const DpPhaseStartedEvent& event)
 {
-  size_t vmem_max = 0;
-  std::vector<size_t> vmem;
+  finish_phase();
+  if (event.phase == "reinitialize")
+  {
+    m_dp_counter++;
+    m_dp_begin_usage = m_phase_begin_usage;
+    m_dp_peak_rss = 0;
+  }
+  m_phase = event.phase;
+  m_stage = event.stage;
+  m_sampler.set_tag(m_phase, m_stage);
+}
 
-  while (!m_end_thread)
+void dynamic_programming::DpStats::finish_phase()
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  ResourceUsage now_usage = get_resource_usage();
+  if (m_phase != "idle")
   {
-    // Get current virtual memory usage using GetProcessMemoryInfo
-    PROCESS_MEMORY_COUNTERS pmc;
-    GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
-    SIZE_T virtualMemUsedByMe = pmc.PeakWorkingSetSize;
-    vmem.push_back(virtualMemUsedByMe);
-    if (virtualMemUsedByMe > vmem_max)
-    {
-      vmem_max = virtualMemUsedByMe;
-    }
-
-    // Sleep for 5 second
-    std::this_thread::sleep_for(std::chrono::seconds(5));
+    ResourceUsage usage = now_usage - m_phase_begin_usage;
+    m_dp_peak_rss = std::max(m_dp_peak_rss, usage.peak_rss);
+    m_phases_file << m_dp_counter << "," << m_phase << "," << m_stage << ","
+      << std::chrono::duration<double, std::milli>(now - m_phase_begin).count() << ","
+      << usage.rss / MB << "," << usage.peak_rss / MB << ","
+      << usage.user_cpu_us / 1000. << "," << usage.sys_cpu_us / 1000. << ","
+      << usage.voluntary_context_switches << "," << usage.involuntary_context_switches << std::endl;
   }
+  // The peak of the next phase starts at the current RSS. Without a reset it stays the peak of the process.
+  reset_peak_rss();
+  m_phase_begin = now;
+  m_phase_begin_usage = now_usage;
+}
 
-  // Print usage to file
-  m_file << "max_virtual_memory_b=" << vmem_max << std::endl;
-  m_file << "max_virtual_memory_mb=" << vmem_max / ((size_t)1024 * 1024) << std::endl;
-  size_t avg = std::accumulate(vmem.begin(), vmem.end(), (size_t)0) / vmem.size();
-  m_file << "avg_virtual_memory_b=" << avg << std::endl;
-  m_file << "avg_virtual_memory_mb=" << avg / ((size_t)1024 * 1024) << std::endl;
+std::vector<dynamic_programming::ResourceSampler::Sample> dynamic_programming::DpStats::write_samples()
+{
+  std::vector<ResourceSampler::Sample> samples = m_sampler.take_samples();
+  for (const ResourceSampler::Sample& sample : samples)
+  {
+    m_samples_file << sample.time.count() << "," << sample.phase << "," << sample.stage << ","
+      << sample.usage.rss / MB << "," << sample.usage.peak_rss / MB << ","
+      << sample.usage.user_cpu_us / 1000. << "," << sample.usage.sys_cpu_us / 1000. << ","
+      << sample.usage.voluntary_context_switches << "," << sample.usage.involuntary_context_switches << std::endl;
+  }
+  return samples;
 }
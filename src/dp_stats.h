@@ -1,36 +1,50 @@
 #pragma once
 
 #include "dynamic_programming.h"
+#include "process_stats.h"
+#include "resource_sampler.h"
 #include <iostream>
-#include "windows.h"
-#include "psapi.h"
 
 namespace dynamic_programming
 {
   class DpStats : public DynamicProgramming::RuntimeLogger
   {
   public:
-    DpStats(const std::string& directory_path)
-      : m_directory_path(directory_path)
-    {
-      m_file.open(directory_path + "dp_stats.txt");
-    }
+    DpStats(const std::string& directory_path, const std::chrono::milliseconds& sample_interval);
 
-    ~DpStats()
-    {
-      m_file.close();
-    }
+    ~DpStats();
 
     void dp_started(const DpStartedEvent& event) override;
 
     void dp_finished(const DpFinishedEvent& event) override;
 
+    void dp_phase_started(const DpPhaseStartedEvent& event) override;
+
   private:
-    void resource_usage();
+    /// <summary>
+    /// Writes the resource usage of the current phase to dp_phases.csv and resets the peak RSS for the next phase
+    /// </summary>
+    void finish_phase();
+
+    /// <summary>
+    /// Writes the samples taken so far to resource_samples.csv and returns them
+    /// </summary>
+    std::vector<ResourceSampler::Sample> write_samples();
 
     const std::string m_directory_path;
     std::ofstream m_file;
-    bool m_end_thread = false;
-    std::thread m_thread;
+    std::ofstream m_phases_file;
+    std::ofstream m_samples_file;
+    ResourceSampler m_sampler;
+    int m_dp_counter = 0;
+    std::string m_phase = "idle";
+    long m_stage = -1;
+    std::chrono::steady_clock::time_point m_phase_begin;
+    ResourceUsage m_phase_begin_usage{};
+    ResourceUsage m_dp_begin_usage{};
+    /// <summary>
+    /// Maximum of the peak RSS of the phases of the current DP
+    /// </summary>
+    size_t m_dp_peak_rss = 0;
   };
-}
\ No newline at end of file
+}
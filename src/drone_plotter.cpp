@@ -170,11 +170,9 @@ void dynamic_programming::DronePlotter::plot_values(Gnuplot& gp)
 
 void dynamic_programming::DronePlotter::plot_path(Gnuplot& gp)
 {
-  CollisionCloud cloud(1, 1, 1, 1);
-  cloud.add_collisions_from_file(Config::get_instance().get(Config::Key::COLLISION_CLOUD_FILE), [](unit3 p) {return CollisionCloud::point3((int)p.x, (int)p.y, (int)p.z); });
   std::vector<std::tuple<int, int, int>> obstacles;
-  for (auto& p : cloud.get_collisions())
-    obstacles.push_back(std::make_tuple(p.x(), p.y(), p.z()));
+  for (const unit3& p : m_ha->get_obstacle_world().get_obstacles())
+    obstacles.push_back(std::make_tuple(p.x, p.y, p.z));
 
   // Prepare gnuplot
   gp << "set xlabel 'x (m)'; set ylabel 'y (m)'; set zlabel 'z (m)'\n";
@@ -216,25 +214,23 @@ void dynamic_programming::DronePlotter::plot_path(Gnuplot& gp)
 
 void dynamic_programming::DronePlotter::plot_2d_path(Gnuplot& gp)
 {
-  // Get collision cloud and only add points with different x/y values
-  CollisionCloud cloud(1, 1, 1, 1);
-  cloud.add_collisions_from_file(Config::get_instance().get(Config::Key::COLLISION_CLOUD_FILE), [](unit3 p) {return CollisionCloud::point3((int)p.x, (int)p.y, (int)p.z); });
+  // Get obstacles and only add points with different x/y values
   std::vector<std::tuple<int, int>> obstacles;
   // Map of x values mapped onto list of y values
   std::unordered_map<int, std::unordered_set<int>> x_to_y;
-  for (auto& p : cloud.get_collisions())
+  for (const unit3& p : m_ha->get_obstacle_world().get_obstacles())
   {
     // If x value doesn't exist yet, add a new list with it and also add the y value and the collision to the list
-    if (!x_to_y.contains(p.x()))
+    if (!x_to_y.contains(p.x))
     {
-      x_to_y[p.x()] = std::unordered_set<int>{p.y()};
-      obstacles.push_back(std::make_tuple(p.x(), p.y()));
+      x_to_y[p.x] = std::unordered_set<int>{p.y};
+      obstacles.push_back(std::make_tuple(p.x, p.y));
     }
     // Else, check if the y value is already in the list, if not, add it and add the collision to the list
-    else if (!x_to_y[p.x()].contains(p.y()))
+    else if (!x_to_y[p.x].contains(p.y))
     {
-      x_to_y[p.x()].insert(p.y());
-      obstacles.push_back(std::make_tuple(p.x(), p.y()));
+      x_to_y[p.x].insert(p.y);
+      obstacles.push_back(std::make_tuple(p.x, p.y));
     }
   }
 
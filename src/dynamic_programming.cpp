@@ -2,11 +2,14 @@
 
 using namespace std;
 
-dynamic_programming::DynamicProgramming::DynamicProgramming(const StateSpace& state_space, const StateSpace& goal_space, const unit delta_time, const unit3 stretch_factor, std::function<unit3(const unit3&)> world_to_dp_coordinates, RuntimeLogger* logger)
-  : m_state_space(state_space),
+dynamic_programming::DynamicProgramming::DynamicProgramming(const StateSpace& state_space, const StateSpace& goal_space, const unit delta_time, const unit3 stretch_factor, const unit3& origin, const ObstacleWorld& world, const Settings& settings, RuntimeLogger* logger)
+  : m_settings(settings),
+  m_num_disturbances(settings.disturbance_on ? NUM_DISTURBANCES : 1),
+  m_state_space(state_space),
   m_goal_space(goal_space),
   m_delta_time(delta_time),
-  m_world_to_dp_coordinates(world_to_dp_coordinates),
+  m_world(world),
+  m_origin(origin),
   m_stretch_factor(stretch_factor),
   m_stretching(stretch_factor.x > 1 || stretch_factor.y > 1 || stretch_factor.z > 1)
 {
@@ -26,6 +29,18 @@ dynamic_programming::DynamicProgramming::~DynamicProgramming()
 
 void dynamic_programming::DynamicProgramming::reinitialize()
 {
+  notify_phase_started("reinitialize");
+  TraceSpan span("reinitialize", "dp");
+
+  // Grid of the previous calculation for a warm start
+  Range old_grids[6];
+  size_t old_lengths[6]{};
+  for (int i = 0; i < 6; i++)
+  {
+    old_grids[i] = m_grids[i];
+    old_lengths[i] = m_lengths[i];
+  }
+
   // Stretch factor
   BOOST_LOG_TRIVIAL(debug) << "stretch factor: " << m_stretch_factor.to_string();
   _ASSERT_EXPR(m_stretch_factor.x >= 1, "stretch factor must be equal to or greater than 1 (x)");
@@ -40,6 +55,7 @@ void dynamic_programming::DynamicProgramming::reinitialize()
     m_grids[i] = m_state_space.get_range(i);
     m_grids[i].set_begin(m_grids[i].get_begin() / m_stretch_factor[i % 3]);
     m_grids[i].set_end(m_grids[i].get_end() / m_stretch_factor[i % 3]);
+    _ASSERT_EXPR(m_grids[i].get_step() == STEP_SIZE, "the integral search in the stages requires a step of STEP_SIZE");
     m_lengths[i] = m_grids[i].length();
     num_states *= m_lengths[i];
     BOOST_LOG_TRIVIAL(debug) << i << ": " << m_grids[i].to_string() << " (length: " << m_lengths[i] << ")";
@@ -56,7 +72,39 @@ void dynamic_programming::DynamicProgramming::reinitialize()
     BOOST_LOG_TRIVIAL(debug) << i << ": " << r.to_string();
   }
 
+  // Check the memory footprint before the structures are (re-)allocated
+  Footprint footprint = admit(num_states);
+
   bool retry = m_V != nullptr;
+  if (retry)
+    Tracer::get_instance().instant("retry", "dp", Tracer::Args().add("num_states", num_states));
+
+  // Keep the calculated stages and the collision memo if the retry can be warm started
+  std::vector<cost_t>().swap(m_warm_start.values);
+  CollisionCloud* old_collision_cloud = nullptr;
+  if (retry && can_warm_start(old_grids))
+  {
+    size_t old_num_states = 1;
+    for (int i = 0; i < 6; i++)
+    {
+      m_warm_start.grids[i] = old_grids[i];
+      m_warm_start.lengths[i] = old_lengths[i];
+      old_num_states *= old_lengths[i];
+    }
+    // Every calculated stage holds costs of trajectories that reach the goal, so their minimum does as well
+    const cost_t* old_values = m_V->data(0);
+    m_warm_start.values.assign(old_values, old_values + old_num_states);
+    for (long stage = 1; stage <= std::min(m_last_computed_steps, (long)m_V->size() - 1); stage++)
+    {
+      old_values = m_V->data(stage);
+      for (size_t j = 0; j < old_num_states; j++)
+        m_warm_start.values[j] = std::min(m_warm_start.values[j], old_values[j]);
+    }
+    old_collision_cloud = m_collision_cloud;
+    m_collision_cloud = nullptr;
+    BOOST_LOG_TRIVIAL(debug) << "Warm starting the retry from " << m_last_computed_steps + 1 << " stages of the previous calculation";
+  }
+  m_last_computed_steps = -1;
 
   // Delete dynamic memory if allocated
   if (m_V != nullptr)
@@ -97,34 +145,88 @@ void dynamic_programming::DynamicProgramming::reinitialize()
   for (int i = 0; i < m_num_disturbances; i++)
     m_disturbances[i] = DISTURBANCES[i] / m_stretch_factor;
 
-  // Get number of stages
-  Config& config = Config::get_instance();
-  int stages = config.get<int>(Config::Key::NUMBER_OF_STAGES);
+  m_smaller_accelerations = create_acceleration_set(m_smaller_inputs, m_disturbances, m_num_disturbances);
+  m_larger_accelerations = create_acceleration_set(m_larger_inputs, m_disturbances, m_num_disturbances);
+  BOOST_LOG_TRIVIAL(debug) << "Distinct accelerations: " << m_smaller_accelerations.size << " and " << m_larger_accelerations.size
+    << " of " << NUM_INPUTS * m_num_disturbances << " pairs of input and disturbance";
 
-  // (Re-)create matrices and collision cloud instance
-  m_V = new matrix<float>(stages, m_lengths[0], m_lengths[1], m_lengths[2], m_lengths[3], m_lengths[4], m_lengths[5]);
-  m_u_opt = new matrix<int>(stages, m_lengths[0], m_lengths[1], m_lengths[2], m_lengths[3], m_lengths[4], m_lengths[5]);
+  // (Re-)create matrices and collision cloud instance. The stages of the matrices are allocated when they are calculated.
+  m_V = new matrix<cost_t>(m_lengths[0], m_lengths[1], m_lengths[2], m_lengths[3], m_lengths[4], m_lengths[5]);
+  m_u_opt = new matrix<int>(m_lengths[0], m_lengths[1], m_lengths[2], m_lengths[3], m_lengths[4], m_lengths[5]);
   m_o_cost = new boost::multi_array<float, 3>(boost::extents[m_lengths[0]][m_lengths[1]][m_lengths[2]]);
   m_collision_cloud = new CollisionCloud(m_lengths[0], m_lengths[1], m_lengths[2], STEP_SIZE);
-  m_collision_cloud->add_collisions_from_file(Config::get_instance().get(Config::Key::COLLISION_CLOUD_FILE),
-    [this](const unit3 &world_point)
+  std::vector<CollisionCloud::point3> view = m_world.get_view(get_region());
+  BOOST_LOG_TRIVIAL(debug) << "Obstacles: " << view.size() << " of " << m_world.get_obstacles().size() << " are near the state space";
+  m_collision_cloud->add_collisions(view);
+  if (old_collision_cloud != nullptr)
+  {
+    // The old view contains every obstacle that can collide with a transition inside the old box, so its memo is still valid
+    CollisionCloud::point3 offset(
+      (old_grids[0].get_begin() - m_grids[0].get_begin()) / STEP_SIZE,
+      (old_grids[1].get_begin() - m_grids[1].get_begin()) / STEP_SIZE,
+      (old_grids[2].get_begin() - m_grids[2].get_begin()) / STEP_SIZE);
+    m_collision_cloud->import_will_collide(*old_collision_cloud, offset);
+    delete old_collision_cloud;
+  }
+
+#ifdef INCLUDE_O_IN_COST
+  // Decide here whether o_cost is used, because the stage kernel depends on it
+  if (m_settings.collision_cost_factor == 0.f)
+  {
+    m_o_cost_used = false;
+    BOOST_LOG_TRIVIAL(debug) << "Collision cost factor is 0. Skipping precalculation of o_cost.";
+  }
+  else if (m_collision_cloud->get_collisions().empty())
+  {
+    m_o_cost_used = false;
+    BOOST_LOG_TRIVIAL(debug) << "Collision cloud is empty. Skipping precalculation of o_cost.";
+  }
+  else
+  {
+    m_o_cost_used = true;
+  }
+#endif
+  // Without obstacles and disturbances nothing couples the axes, and without obstacles o_cost isn't used either
+  m_separable = m_settings.separable_legs && m_num_disturbances == 1 && m_collision_cloud->get_collisions().empty();
+  m_pruning = !m_separable && m_settings.prune_infeasible_states;
+  m_axes.clear();
+  for (int i = 0; i < 3; i++)
+    m_axes.emplace_back(m_grids[i], m_grids[i + 3], m_goal_space, i, m_stretch_factor[i], m_delta_time);
+  if (m_separable)
+  {
+    BOOST_LOG_TRIVIAL(debug) << "Leg is separable. Solving three (position, velocity) problems instead of the 6D one.";
+  }
+  else
+  {
+    if (m_pruning)
     {
-      unit3 dp_point = m_world_to_dp_coordinates(world_point);
-      dp_point /= m_stretch_factor;
-      return CollisionCloud::point3(m_grids[0].search_closest(dp_point.x), m_grids[1].search_closest(dp_point.y), m_grids[2].search_closest(dp_point.z));
+      size_t feasible_states = calculate_feasible_states();
+      BOOST_LOG_TRIVIAL(debug) << "Feasible states: " << feasible_states << " of " << num_states << ". The others are pruned.";
     }
-  );
+    if (m_settings.enable_cost_bound)
+    {
+      for (int i = 0; i < 3; i++)
+        m_axes[i].calculate_cost_lower_bound(get_input_components(i));
+    }
+  }
+  m_stage_kernel = select_stage_kernel();
+  calculate_sweep_order();
 
   // Reset other variables
   m_i_x0 = nullptr;
   m_initial_region.clear();
-  m_break_on_initial_region_covered_fixpoint_reached = config.get<bool>(Config::Key::ENABLE_INITIAL_FIX_POINT);
-  m_break_on_norm_fixpoint_reached = config.get<bool>(Config::Key::ENABLE_NORM_FIX_POINT);
+  // The value of a stationary solver keeps improving after the initial region is covered, so only the value fix point ends its sweeps
+  const bool stationary = m_settings.solver != Settings::JACOBI && !m_separable;
+  m_break_on_initial_region_covered_fixpoint_reached = m_settings.enable_initial_fix_point && !stationary;
+  m_break_on_norm_fixpoint_reached = m_settings.enable_norm_fix_point && !stationary;
 
+  size_t estimated_bytes = footprint.total();
   RuntimeLogger::DpStartedEvent event
   {
     num_states,
-    retry
+    retry,
+    estimated_bytes,
+    m_number_of_stages
   };
   if (m_runtime_logger != nullptr)
     m_runtime_logger->dp_started(event);
@@ -133,115 +235,205 @@ void dynamic_programming::DynamicProgramming::reinitialize()
 long dynamic_programming::DynamicProgramming::calculate_controller(float x0[6])
 {
   std::chrono::steady_clock::time_point total_begin = std::chrono::steady_clock::now();
+  TraceSpan dp_span("calculate_controller", "dp");
 
   // Get index of x0
   int i_x0[6]{};
   for (int i = 0; i < 6; i++)
     i_x0[i] = m_grids[i].search(x0[i] / m_stretch_factor[i % 3]);
 
+  if (m_separable)
+    return calculate_separable_controller(i_x0, total_begin);
+
   // Fill terminal costs
+  notify_phase_started("terminal_costs");
   BOOST_LOG_TRIVIAL(debug) << "### final stage ###";
-  size_t terminal_states = fill_terminal_costs();
-  BOOST_LOG_TRIVIAL(debug) << "Number of states in goal space: " << terminal_states;
-
-#ifdef INCLUDE_O_IN_COST
-  // Precalculate m_o_cost
-  Config& config = Config::get_instance();
-  if (!config.is_set(Config::Key::COLLISION_COST_FACTOR) || config.get<float>(Config::Key::COLLISION_COST_FACTOR) == 0.f)
+  size_t terminal_states = 0;
   {
-    m_o_cost_used = false;
-    BOOST_LOG_TRIVIAL(debug) << "Collision cost factor is 0. Skipping precalculation of o_cost.";
+    TraceSpan span("terminal_costs", "dp");
+    terminal_states = fill_terminal_costs();
   }
-  else if (m_collision_cloud->get_collisions().empty())
+  BOOST_LOG_TRIVIAL(debug) << "Number of states in goal space: " << terminal_states;
+  m_time_pruning = m_pruning && m_settings.solver == Settings::JACOBI && m_warm_start.values.empty();
+  m_cost_bound = COST_INF;
+  if (!m_warm_start.values.empty())
   {
-    m_o_cost_used = false;
-    BOOST_LOG_TRIVIAL(debug) << "Collision cloud is empty. Skipping precalculation of o_cost.";
+    size_t seeded_states = apply_warm_start();
+    BOOST_LOG_TRIVIAL(debug) << "Warm start: " << seeded_states << " states with finite cost-to-go taken from the previous calculation";
   }
-  else
+
+#ifdef INCLUDE_O_IN_COST
+  // Precalculate m_o_cost
+  if (m_o_cost_used)
   {
-    m_o_cost_used = true;
+    notify_phase_started("o_cost");
+    TraceSpan span("o_cost", "dp");
     BOOST_LOG_TRIVIAL(debug) << "### precalculate o_cost ###";
-    float factor = Config::get_instance().get<float>(Config::Key::COLLISION_COST_FACTOR);
+    float factor = m_settings.collision_cost_factor;
+    // Squared distances to the closest obstacle are shared between all instances with the same region
+    std::shared_ptr<const std::vector<float>> distance_field = m_world.get_distance_field(get_region());
+    size_t i_cell = 0;
     for (int i_c1 = 0; i_c1 < m_lengths[0]; i_c1++)
-    {
       for (int i_c2 = 0; i_c2 < m_lengths[1]; i_c2++)
-      {
         for (int i_c3 = 0; i_c3 < m_lengths[2]; i_c3++)
         {
-          // Iterate over all obstacles in the collision cloud to find the one which is closest to c
-          std::vector<CollisionCloud::point3>& collisions = m_collision_cloud->get_collisions();
-          float min_distance_2 = numeric_limits<float>::max();
-          for (CollisionCloud::point3& collision : collisions)
-          {
-            CollisionCloud::point3 subtraction(i_c1 - collision.x(), i_c2 - collision.y(), i_c3 - collision.z());
-            float distance_2 = bg::dot_product(subtraction, subtraction);
-            if (distance_2 < min_distance_2)
-            {
-              min_distance_2 = distance_2;
-            }
-          }
-
           // Calculate cost from closest collision
-          float cost = 0;
-          cost = factor / (sqrt(min_distance_2));
+          float cost = factor / (sqrt((*distance_field)[i_cell++]));
           (*m_o_cost)[i_c1][i_c2][i_c3] = cost;
         }
-      }
-    }
   }
 #endif
 
-  // Get number of stages
-  int stages = config.get<int>(Config::Key::NUMBER_OF_STAGES);
-
   // Set up threads
-  thread threads[NUM_THREADS];
-  size_t chunk_size = m_lengths[3] / NUM_THREADS;
-  size_t rest = m_lengths[3] - chunk_size * NUM_THREADS;
+  const size_t num_threads = m_settings.num_threads;
+  std::vector<thread> threads(num_threads);
+  size_t chunk_size = m_lengths[3] / num_threads;
+  size_t rest = m_lengths[3] - chunk_size * num_threads;
 
   const unit3* inputs = m_smaller_inputs;
+  const AccelerationSet* accelerations = &m_smaller_accelerations;
 
   bool x0_reached = false;
   int finite_states_changed = 0;
   size_t last_finite_states = 0;
+  size_t last_stage_finite_states = 0;
 
   std::vector<std::chrono::nanoseconds> stage_durations;
 
   BOOST_LOG_TRIVIAL(debug) << "### recursive calculation of optimal cost-to-go ###";
-  long i_time = stages - 2;
-  for ( ; i_time >= 0; i_time--)
+  // Stationary solvers iterate stage 1 in place, starting from the terminal costs
+  if (m_settings.solver != Settings::JACOBI)
+  {
+    allocate_stage(1);
+    std::copy(m_V->data(0), m_V->data(0) + m_V->slice_size(), m_V->data(1));
+    std::fill(m_u_opt->data(1), m_u_opt->data(1) + m_u_opt->slice_size(), -1);
+  }
+
+  // Stages are calculated by the number of steps to go. i_time is the stage of the horizon they correspond to.
+  long last_steps = 0;
+  bool converged = false;
+  float last_max_value_change = 0.f;
+  for (long steps = 1; ; steps++)
   {
+    if (steps >= m_number_of_stages && !extend_horizon(i_x0, last_stage_finite_states, finite_states_changed))
+      break;
+    const long i_time = m_number_of_stages - 1 - steps;
+    const long i_stage = storage_stage(steps);
+    allocate_stage(i_stage);
+
+    notify_phase_started("stage", i_time);
+    TraceSpan stage_span("stage", "dp", Tracer::Args().add("stage", i_time));
     std::chrono::steady_clock::time_point stage_begin = std::chrono::steady_clock::now();
 
-    if (stages - i_time > INPUTS_SMALLER_STAGES)
+    if (steps + 1 > INPUTS_SMALLER_STAGES)
+    {
       inputs = m_larger_inputs;
+      accelerations = &m_larger_accelerations;
+    }
 
     size_t all_finite_states = 0;
-    size_t finite_states[NUM_THREADS]{ 0 };
+    std::vector<StageStats> stage_stats(num_threads);
 
     size_t start = 0;
     size_t end = 0;
 
-    for (size_t i_thread = 0; i_thread < NUM_THREADS; i_thread++)
+    for (size_t i_thread = 0; i_thread < num_threads; i_thread++)
     {
       start = end;
       end += chunk_size;
       if (i_thread < rest)
         end++;
 
-      threads[i_thread] = thread(&DynamicProgramming::calculate_one_stage_threaded, this, i_time, start, end, &(finite_states[i_thread]), inputs);
+      threads[i_thread] = thread([this, i_thread, i_time, i_stage, start, end, &stage_stats, accelerations]()
+        {
+          Tracer::get_instance().set_thread_lane((int)i_thread + 1, "worker " + std::to_string(i_thread));
+          TraceSpan span("chunk", "dp", Tracer::Args().add("stage", i_time).add("start", start).add("end", end));
+          if (m_settings.perf_counters)
+          {
+            PerfCounters counters;
+            counters.start();
+            (this->*m_stage_kernel)(i_stage, start, end, &(stage_stats[i_thread]), accelerations);
+            stage_stats[i_thread].perf = counters.stop();
+          }
+          else
+          {
+            (this->*m_stage_kernel)(i_stage, start, end, &(stage_stats[i_thread]), accelerations);
+          }
+        });
     }
 
     _ASSERT_EXPR(end == m_lengths[3], "Calculation of thread chunk sizes failed");
 
-    for (size_t i_thread = 0; i_thread < NUM_THREADS; i_thread++)
-    {
+    for (size_t i_thread = 0; i_thread < num_threads; i_thread++)
       threads[i_thread].join();
-      all_finite_states += finite_states[i_thread];
-    }
 
     std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - stage_begin;
     stage_durations.push_back(duration);
+
+    // Sum up the counters of the threads
+    size_t evaluated_states = 0;
+    size_t skipped_states = 0;
+    CollisionCloud::Stats collisions;
+    float max_value_change = 0.f;
+    size_t policy_changes = 0;
+    std::vector<std::chrono::nanoseconds> thread_busy(num_threads);
+    std::vector<std::chrono::nanoseconds> thread_idle(num_threads);
+    PerfCounters::Values perf;
+    std::vector<PerfCounters::Values> thread_perf(num_threads);
+    for (size_t i_thread = 0; i_thread < num_threads; i_thread++)
+    {
+      all_finite_states += stage_stats[i_thread].finite_states;
+      evaluated_states += stage_stats[i_thread].evaluated_states;
+      skipped_states += stage_stats[i_thread].skipped_states;
+      collisions += stage_stats[i_thread].collisions;
+      max_value_change = std::max(max_value_change, stage_stats[i_thread].max_value_change);
+      policy_changes += stage_stats[i_thread].policy_changes;
+      thread_busy[i_thread] = stage_stats[i_thread].busy;
+      thread_idle[i_thread] = duration - stage_stats[i_thread].busy;
+      perf += stage_stats[i_thread].perf;
+      thread_perf[i_thread] = stage_stats[i_thread].perf;
+    }
+    last_stage_finite_states = all_finite_states;
+    last_steps = steps;
+
+    // Trajectories of the initial state that start in this stage only pass states whose value is at most the one of the
+    // initial state. Later stages are pruned by the lowest value so far, which assumes that the value of the initial state
+    // doesn't grow with more stages. It can, e.g. if disturbances push the drone out of the goal, so the end is checked below.
+    bool x0_in_grid = std::all_of(i_x0, i_x0 + 6, [](const int i) { return i >= 0; });
+    if (m_settings.enable_cost_bound && x0_in_grid)
+    {
+      cost_t value_x0 = m_V->at(i_stage, i_x0[0], i_x0[1], i_x0[2], i_x0[3], i_x0[4], i_x0[5]);
+      if (value_x0 < m_cost_bound)
+      {
+        m_cost_bound = value_x0;
+        BOOST_LOG_TRIVIAL(debug) << "Cost bound lowered to " << m_cost_bound;
+      }
+    }
+
+    // Optimal inputs index different input sets if the stage with one step less used the other set
+    bool policies_comparable = steps > 1 && (steps > INPUTS_SMALLER_STAGES) == (steps + 1 > INPUTS_SMALLER_STAGES);
+    if (!policies_comparable)
+      policy_changes = 0;
+
+    RuntimeLogger::DpStageFinishedEvent stage_event
+    {
+      i_time,
+      duration,
+      all_finite_states,
+      evaluated_states,
+      skipped_states,
+      collisions.checks,
+      collisions.memo_hits,
+      collisions.obstacles_scanned,
+      max_value_change,
+      policy_changes,
+      thread_busy,
+      thread_idle,
+      perf,
+      thread_perf
+    };
+    if (m_runtime_logger != nullptr)
+      m_runtime_logger->dp_stage_finished(stage_event);
     BOOST_LOG_TRIVIAL(debug) << "Stage " << i_time << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms. Number of states with finite cost-to-go: " << all_finite_states;
 
     // Check if number of finite states has changed
@@ -255,39 +447,71 @@ long dynamic_programming::DynamicProgramming::calculate_controller(float x0[6])
     {
       BOOST_LOG_TRIVIAL(debug) << "Number of finite cost states hasn't changed in three stages. Fix point has probably been reached.";
       if (m_break_on_norm_fixpoint_reached)
-      {
-        i_time--;
         break;
-      }
     }
-    if (initial_region_is_covered(i_time, i_x0))
+    // Stationary solvers have no horizon and sweep until the value fix point or the maximum number of stages
+    last_max_value_change = max_value_change;
+    if ((m_settings.enable_value_fix_point || m_settings.solver != Settings::JACOBI) && max_value_change <= m_settings.value_fix_point_tolerance)
+    {
+      BOOST_LOG_TRIVIAL(debug) << "Values changed by at most " << max_value_change << " in the last stage. Value function has converged.";
+      converged = true;
+      break;
+    }
+    if (m_settings.enable_policy_fix_point && policies_comparable
+      && policy_changes <= m_settings.policy_fix_point_tolerance * (evaluated_states + skipped_states))
+    {
+      BOOST_LOG_TRIVIAL(debug) << policy_changes << " states changed their optimal input in the last stage. Policy has converged.";
+      converged = true;
+      break;
+    }
+    if (initial_region_is_covered(i_stage, i_x0))
     {
       BOOST_LOG_TRIVIAL(debug) << "Initial region is covered. Shortest path has been calculated.";
       if (m_break_on_initial_region_covered_fixpoint_reached)
-      {
-        i_time--;
         break;
-      }
+    }
+
+    // Policy iteration evaluates the improved policy before the next sweep
+    if (m_settings.solver == Settings::POLICY_ITERATION)
+    {
+      notify_phase_started("policy_evaluation", i_time);
+      TraceSpan span("policy_evaluation", "dp", Tracer::Args().add("stage", i_time));
+      std::chrono::steady_clock::time_point evaluation_begin = std::chrono::steady_clock::now();
+      size_t lowered = evaluate_policy(inputs);
+      BOOST_LOG_TRIVIAL(debug) << "Policy evaluation took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - evaluation_begin).count()
+        << " ms. Number of lowered values: " << lowered;
     }
 
     last_finite_states = all_finite_states;
   }
 
-  i_time++;
+  m_last_computed_steps = last_steps;
+  if (m_settings.enable_cost_bound && std::all_of(i_x0, i_x0 + 6, [](const int i) { return i >= 0; }))
+  {
+    cost_t value_x0 = m_V->at(storage_stage(last_steps), i_x0[0], i_x0[1], i_x0[2], i_x0[3], i_x0[4], i_x0[5]);
+    if (value_x0 > m_cost_bound)
+      BOOST_LOG_TRIVIAL(warning) << "Value of the initial state grew from " << m_cost_bound << " to " << value_x0
+        << " in later stages. States of its trajectories may have been skipped by the cost bound.";
+  }
+  if (m_settings.solver != Settings::JACOBI && !converged)
+    BOOST_LOG_TRIVIAL(warning) << "Stationary solver stopped after " << last_steps << " sweeps before the value function converged. Values changed by up to "
+      << last_max_value_change << " in the last sweep, so the policy may not be stationary.";
 
   RuntimeLogger::DpFinishedEvent event
   {
     std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - total_begin),
     std::chrono::duration_cast<std::chrono::milliseconds>(stage_durations[0]),
-    std::chrono::duration_cast<std::chrono::milliseconds>(std::accumulate(stage_durations.begin(), stage_durations.end(), std::chrono::nanoseconds(0)) / stage_durations.size())
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::accumulate(stage_durations.begin(), stage_durations.end(), std::chrono::nanoseconds(0)) / stage_durations.size()),
+    stage_durations.size(),
+    last_stage_finite_states
   };
   if (m_runtime_logger != nullptr)
     m_runtime_logger->dp_finished(event);
 
-  if (initial_region_is_covered(i_time, i_x0))
+  if (initial_region_is_covered(storage_stage(last_steps), i_x0))
   {
     BOOST_LOG_TRIVIAL(debug) << "Initial region is covered.";
-    return i_time;
+    return m_number_of_stages - 1 - last_steps;
   }
   else
   {
@@ -298,22 +522,38 @@ long dynamic_programming::DynamicProgramming::calculate_controller(float x0[6])
 
 const dynamic_programming::unit3 dynamic_programming::DynamicProgramming::get_control(const float x[6], long i_time) const
 {
-  Config& config = Config::get_instance();
-  int stages = config.get<int>(Config::Key::NUMBER_OF_STAGES);
-  const unit3* inputs = stages - i_time > INPUTS_SMALLER_STAGES ? m_larger_inputs : m_smaller_inputs;
-  if (i_time >= stages - 1)
+  const long steps = m_number_of_stages - 1 - i_time;
+  const unit3* inputs = steps + 1 > INPUTS_SMALLER_STAGES ? m_larger_inputs : m_smaller_inputs;
+  if (steps <= 0)
     throw std::logic_error("It took too many stages to reach 0. Controller wasn't calculated that far.");
+  if (m_separable ? !m_axes[0].is_calculated(steps) : !m_u_opt->is_allocated(storage_stage(steps)))
+    throw std::logic_error("Controller wasn't calculated for stage " + std::to_string(i_time) + ".");
   int i_x[6]{};
   for (int i = 0; i < 6; i++)
     i_x[i] = m_grids[i].search(x[i] / m_stretch_factor[i % 3]);
 
-  int i_u = m_u_opt->at(i_time, i_x[0], i_x[1], i_x[2], i_x[3], i_x[4], i_x[5]);
+  int i_u = 0;
+  if (m_separable)
+  {
+    // The inputs are ordered like the digits of a number with the components of x, y and z
+    for (int i = 0; i < 3; i++)
+    {
+      int component = m_axes[i].policy(steps, i_x[i], i_x[i + 3]);
+      if (component < 0)
+        throw std::logic_error("Axis " + std::to_string(i) + " returned invalid optimal input component: " + std::to_string(component));
+      i_u = i_u * AxisProblem::NUM_COMPONENTS + component;
+    }
+  }
+  else
+  {
+    i_u = m_u_opt->at(storage_stage(steps), i_x[0], i_x[1], i_x[2], i_x[3], i_x[4], i_x[5]);
+  }
   if (i_u < 0 || i_u > NUM_INPUTS)
     throw std::logic_error("Controller returned invalid optimal u index: " + std::to_string(i_u));
   return inputs[i_u] * m_stretch_factor;
 }
 
-float dynamic_programming::DynamicProgramming::terminal_cost(const unit x[6]) const
+dynamic_programming::cost_t dynamic_programming::DynamicProgramming::terminal_cost(const unit x[6]) const
 {
   bool contains;
   if (m_stretching)
@@ -330,12 +570,27 @@ float dynamic_programming::DynamicProgramming::terminal_cost(const unit x[6]) co
   {
     contains = m_goal_space.contains(x);
   }
-  return contains ? 0.f : numeric_limits<float>::max();
+  return contains ? 0 : COST_INF;
 }
 
-float dynamic_programming::DynamicProgramming::running_cost(const unit x[6], const unit3& input, const int i_c1, const int i_c2, const int i_c3) const
+template <bool Stretching, bool OCostUsed>
+dynamic_programming::cost_t dynamic_programming::DynamicProgramming::running_cost(const unit x[6], const unit3& input, const int i_c1, const int i_c2, const int i_c3) const
 {
-  if (m_stretching)
+  if (successor_in_goal<Stretching>(x))
+    return 0;
+
+  float o_cost = 0.f;
+#ifdef INCLUDE_O_IN_COST
+  if constexpr (OCostUsed)
+    o_cost = (*m_o_cost)[i_c1][i_c2][i_c3];
+#endif
+  return combine_running_cost<OCostUsed>(input.x * input.x + input.y * input.y + input.z * input.z, squared_norm(x), o_cost);
+}
+
+template <bool Stretching>
+bool dynamic_programming::DynamicProgramming::successor_in_goal(const unit x[6]) const
+{
+  if constexpr (Stretching)
   {
     unit x_stretched[6]{};
     for (int i = 0; i < 3; i++)
@@ -343,166 +598,325 @@ float dynamic_programming::DynamicProgramming::running_cost(const unit x[6], con
       x_stretched[i] = x[i] * m_stretch_factor[i];
       x_stretched[i + 3] = x[i + 3] * m_stretch_factor[i];
     }
-    if (m_goal_space.contains(x_stretched))
-      return 0.f;
+    return m_goal_space.contains(x_stretched);
   }
   else
   {
-    if (m_goal_space.contains(x))
-      return 0.f;
+    return m_goal_space.contains(x);
   }
+}
 
-  float cost = input.x * input.x + input.y * input.y + input.z * input.z;
+int dynamic_programming::DynamicProgramming::squared_norm(const unit x[6])
+{
+  int norm = 0;
   for (int i = 0; i < 6; i++)
-    cost += x[i] * x[i];
+    norm += x[i] * x[i];
+  return norm;
+}
+
+template <bool OCostUsed>
+dynamic_programming::cost_t dynamic_programming::DynamicProgramming::combine_running_cost(const int input_norm, const int squared_norm, const float o_cost) const
+{
+  // The norms are summed as integers. That is exact, as was summing them as floats, as long as they stay below 2^24.
+#if _INTEGER_COSTS == 1
+  // The config validation rejects collision costs with integer costs, so o_cost is never used
+  return (cost_t)(input_norm + squared_norm) * (cost_t)m_delta_time;
+#else
+  float cost = (float)(input_norm + squared_norm);
+  if constexpr (OCostUsed)
+    cost += o_cost;
+  return cost * m_delta_time;
+#endif
+}
+
+dynamic_programming::DynamicProgramming::AccelerationSet dynamic_programming::DynamicProgramming::create_acceleration_set(const unit3* inputs, const unit3* disturbances, const int num_disturbances)
+{
+  AccelerationSet set;
+  for (int i = 0; i < NUM_INPUTS; i++)
+    set.input_norms[i] = inputs[i].x * inputs[i].x + inputs[i].y * inputs[i].y + inputs[i].z * inputs[i].z;
+  // With a single disturbance only the zero disturbance is applied
+  for (int j = 0; j < num_disturbances; j++)
+    for (int i = 0; i < NUM_INPUTS; i++)
+    {
+      unit3 acceleration = num_disturbances > 1 ? inputs[i] + disturbances[j] : inputs[i];
+      auto it = std::find_if(set.accelerations, set.accelerations + set.size, [&](const unit3& a) { return a.x == acceleration.x && a.y == acceleration.y && a.z == acceleration.z; });
+      if (it == set.accelerations + set.size)
+        set.accelerations[set.size++] = acceleration;
+      set.index[j][i] = (int)(it - set.accelerations);
+    }
+  return set;
+}
+
+// Instantiated explicitly for the micro benchmark
+template dynamic_programming::cost_t dynamic_programming::DynamicProgramming::running_cost<false, false>(const unit x[6], const unit3& input, const int i_c1, const int i_c2, const int i_c3) const;
+
+dynamic_programming::DynamicProgramming::StageKernel dynamic_programming::DynamicProgramming::select_stage_kernel() const
+{
+  constexpr bool drag = DRAG_FORCE_COEFFICIENT != 0;
+  // Indexed by [in place][stretching][o_cost_used][disturbances on]
+  static const StageKernel kernels[2][2][2][2] =
+  {
+    {
+      {
+        { &DynamicProgramming::calculate_one_stage_threaded<false, false, 1, drag, false>, &DynamicProgramming::calculate_one_stage_threaded<false, false, NUM_DISTURBANCES, drag, false> },
+        { &DynamicProgramming::calculate_one_stage_threaded<false, true, 1, drag, false>, &DynamicProgramming::calculate_one_stage_threaded<false, true, NUM_DISTURBANCES, drag, false> }
+      },
+      {
+        { &DynamicProgramming::calculate_one_stage_threaded<true, false, 1, drag, false>, &DynamicProgramming::calculate_one_stage_threaded<true, false, NUM_DISTURBANCES, drag, false> },
+        { &DynamicProgramming::calculate_one_stage_threaded<true, true, 1, drag, false>, &DynamicProgramming::calculate_one_stage_threaded<true, true, NUM_DISTURBANCES, drag, false> }
+      }
+    },
+    {
+      {
+        { &DynamicProgramming::calculate_one_stage_threaded<false, false, 1, drag, true>, &DynamicProgramming::calculate_one_stage_threaded<false, false, NUM_DISTURBANCES, drag, true> },
+        { &DynamicProgramming::calculate_one_stage_threaded<false, true, 1, drag, true>, &DynamicProgramming::calculate_one_stage_threaded<false, true, NUM_DISTURBANCES, drag, true> }
+      },
+      {
+        { &DynamicProgramming::calculate_one_stage_threaded<true, false, 1, drag, true>, &DynamicProgramming::calculate_one_stage_threaded<true, false, NUM_DISTURBANCES, drag, true> },
+        { &DynamicProgramming::calculate_one_stage_threaded<true, true, 1, drag, true>, &DynamicProgramming::calculate_one_stage_threaded<true, true, NUM_DISTURBANCES, drag, true> }
+      }
+    }
+  };
 #ifdef INCLUDE_O_IN_COST
-  if (m_o_cost_used)
-    cost += (*m_o_cost)[i_c1][i_c2][i_c3];
+  bool o_cost_used = m_o_cost_used;
+#else
+  bool o_cost_used = false;
 #endif
-  return cost * m_delta_time;
+  bool in_place = m_settings.solver != Settings::JACOBI;
+  BOOST_LOG_TRIVIAL(debug) << "Stage kernel: stretching " << m_stretching << ", o_cost " << o_cost_used << ", disturbances " << m_num_disturbances << ", drag " << drag << ", in place " << in_place;
+  return kernels[in_place][m_stretching][o_cost_used][m_num_disturbances > 1];
+}
+
+/// <summary>
+/// Values of an in-place sweep are read and written by several workers at once. Relaxed atomics compile to plain moves,
+/// because it doesn't matter whether a worker sees the old or the updated value.
+/// </summary>
+template <bool InPlace, typename T>
+static inline T load_value(T& value)
+{
+  if constexpr (InPlace)
+    return std::atomic_ref<T>(value).load(std::memory_order_relaxed);
+  else
+    return value;
+}
+
+template <bool InPlace, typename T>
+static inline void store_value(T& value, const T new_value)
+{
+  if constexpr (InPlace)
+    std::atomic_ref<T>(value).store(new_value, std::memory_order_relaxed);
+  else
+    value = new_value;
+}
+
+/// <summary>
+/// Change of a finite value relative to the previous one. Integer costs are subtracted in the order that doesn't wrap around.
+/// </summary>
+static inline float relative_value_change(const dynamic_programming::cost_t value, const dynamic_programming::cost_t previous_value)
+{
+  float difference = value > previous_value ? (float)(value - previous_value) : (float)(previous_value - value);
+  return difference / std::max(1.f, (float)previous_value);
 }
 
-void dynamic_programming::DynamicProgramming::calculate_one_stage_threaded(const long stage, const size_t start_i_v1, const size_t end_i_v1, size_t* finite_states, const unit3* inputs)
+template <bool Stretching, bool OCostUsed, size_t NumDisturbances, bool Drag, bool InPlace>
+void dynamic_programming::DynamicProgramming::calculate_one_stage_threaded(const long stage, const size_t start_i_v1, const size_t end_i_v1, StageStats* stats, const AccelerationSet* accelerations)
 {
-  unit drag;
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
   // Allocate arrays only once to maybe save runtime
-  unit new_v1s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  int i_new_v1s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  unit new_v2s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  int i_new_v2s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  unit new_v3s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  int i_new_v3s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  unit new_c1s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  int i_new_c1s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  unit new_c2s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  int i_new_c2s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  unit new_c3s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  int i_new_c3s[NUM_INPUTS][NUM_DISTURBANCES]{};
-  bool valid[NUM_INPUTS][NUM_DISTURBANCES]{};
+  // Arrays are indexed by the distinct accelerations, so that every successor is searched and evaluated once
+  constexpr size_t MAX_SUCCESSORS = NUM_INPUTS * NumDisturbances;
+  unit new_v1s[MAX_SUCCESSORS]{};
+  int i_new_v1s[MAX_SUCCESSORS]{};
+  unit new_v2s[MAX_SUCCESSORS]{};
+  int i_new_v2s[MAX_SUCCESSORS]{};
+  unit new_v3s[MAX_SUCCESSORS]{};
+  int i_new_v3s[MAX_SUCCESSORS]{};
+  unit new_c1s[MAX_SUCCESSORS]{};
+  int i_new_c1s[MAX_SUCCESSORS]{};
+  unit new_c2s[MAX_SUCCESSORS]{};
+  int i_new_c2s[MAX_SUCCESSORS]{};
+  unit new_c3s[MAX_SUCCESSORS]{};
+  int i_new_c3s[MAX_SUCCESSORS]{};
+  bool valid[MAX_SUCCESSORS]{};
+  // Cost of every distinct successor without the input part of the running cost
+  bool blocked[MAX_SUCCESSORS]{};
+  bool in_goal[MAX_SUCCESSORS]{};
+  int squared_norms[MAX_SUCCESSORS]{};
+  cost_t next_costs_to_go[MAX_SUCCESSORS]{};
+  const size_t num_successors = accelerations->size;
+  const unit3* unique = accelerations->accelerations;
+  // Stage the successors are read from
+  const long next_stage = InPlace ? stage : stage - 1;
+  // States that need more steps to the goal than the stage has were marked by allocate_stage
+  const int max_steps = m_time_pruning ? (int)stage : AxisProblem::UNREACHABLE - 1;
+  const cost_t cost_bound = m_cost_bound;
 
   // x velocity
-  for (size_t i_v1 = start_i_v1; i_v1 < end_i_v1; i_v1++)
+  for (size_t n_v1 = start_i_v1; n_v1 < end_i_v1; n_v1++)
   {
-    unit v1 = m_grids[3][i_v1];
+    const size_t i_v1 = InPlace ? m_sweep_order[3][n_v1] : n_v1;
+    unit v1 = m_grids[3].value_at(i_v1);
 
-    for (int i = 0; i < NUM_INPUTS; i++)
-      for (int j = 0; j < m_num_disturbances; j++)
-      {
-        drag = -DRAG_FORCE_COEFFICIENT * v1;
-        new_v1s[i][j] = v1 + (inputs[i].x + m_disturbances[j].x + drag) * m_delta_time;
-        i_new_v1s[i][j] = m_grids[3].search(new_v1s[i][j]);
-      }
+    for (size_t a = 0; a < num_successors; a++)
+    {
+      unit acceleration = unique[a].x;
+      if constexpr (Drag)
+        acceleration += -DRAG_FORCE_COEFFICIENT * v1;
+      new_v1s[a] = v1 + acceleration * m_delta_time;
+    }
+    m_grids[3].search_integral<STEP_SIZE>(new_v1s, i_new_v1s, num_successors);
 
     // y velocity
-    for (int i_v2 = 0; i_v2 < m_lengths[4]; i_v2++)
+    for (int n_v2 = 0; n_v2 < m_lengths[4]; n_v2++)
     {
-      unit v2 = m_grids[4][i_v2];
+      const int i_v2 = InPlace ? m_sweep_order[4][n_v2] : n_v2;
+      unit v2 = m_grids[4].value_at(i_v2);
 
-      for (int i = 0; i < NUM_INPUTS; i++)
-        for (int j = 0; j < m_num_disturbances; j++)
-        {
-          drag = -DRAG_FORCE_COEFFICIENT * v2;
-          new_v2s[i][j] = v2 + (inputs[i].y + m_disturbances[j].y + drag) * m_delta_time;
-          i_new_v2s[i][j] = m_grids[4].search(new_v2s[i][j]);
-        }
+      for (size_t a = 0; a < num_successors; a++)
+      {
+        unit acceleration = unique[a].y;
+        if constexpr (Drag)
+          acceleration += -DRAG_FORCE_COEFFICIENT * v2;
+        new_v2s[a] = v2 + acceleration * m_delta_time;
+      }
+      m_grids[4].search_integral<STEP_SIZE>(new_v2s, i_new_v2s, num_successors);
 
       // z velocity
-      for (int i_v3 = 0; i_v3 < m_lengths[5]; i_v3++)
+      for (int n_v3 = 0; n_v3 < m_lengths[5]; n_v3++)
       {
-        unit v3 = m_grids[5][i_v3];
+        const int i_v3 = InPlace ? m_sweep_order[5][n_v3] : n_v3;
+        unit v3 = m_grids[5].value_at(i_v3);
 
-        for (int i = 0; i < NUM_INPUTS; i++)
-          for (int j = 0; j < m_num_disturbances; j++)
-          {
-            drag = -DRAG_FORCE_COEFFICIENT * v3;
-            new_v3s[i][j] = v3 + (inputs[i].z + m_disturbances[j].z + drag) * m_delta_time;
-            i_new_v3s[i][j] = m_grids[5].search(new_v3s[i][j]);
-          }
+        for (size_t a = 0; a < num_successors; a++)
+        {
+          unit acceleration = unique[a].z;
+          if constexpr (Drag)
+            acceleration += -DRAG_FORCE_COEFFICIENT * v3;
+          new_v3s[a] = v3 + acceleration * m_delta_time;
+        }
+        m_grids[5].search_integral<STEP_SIZE>(new_v3s, i_new_v3s, num_successors);
 
         // x coordinate
-        for (int i_c1 = 0; i_c1 < m_lengths[0]; i_c1++)
+        for (int n_c1 = 0; n_c1 < m_lengths[0]; n_c1++)
         {
-          unit c1 = m_grids[0][i_c1];
+          const int i_c1 = InPlace ? m_sweep_order[0][n_c1] : n_c1;
+          // Pruned states already have infinite costs, because allocate_stage marked them
+          if (m_axes[0].steps_to_goal(i_c1, i_v1) > max_steps)
+          {
+            stats->skipped_states += m_lengths[1] * m_lengths[2];
+            continue;
+          }
+          unit c1 = m_grids[0].value_at(i_c1);
+          const float lower_bound_c1 = m_axes[0].cost_lower_bound(i_c1, i_v1);
 
-          for (int i = 0; i < NUM_INPUTS; i++)
-            for (int j = 0; j < m_num_disturbances; j++)
-            {
-              new_c1s[i][j] = c1 + new_v1s[i][j] * m_delta_time;
-              i_new_c1s[i][j] = m_grids[0].search(new_c1s[i][j]);
-            }
+          for (size_t a = 0; a < num_successors; a++)
+            new_c1s[a] = c1 + new_v1s[a] * m_delta_time;
+          m_grids[0].search_integral<STEP_SIZE>(new_c1s, i_new_c1s, num_successors);
 
           // y coordinate
-          for (int i_c2 = 0; i_c2 < m_lengths[1]; i_c2++)
+          for (int n_c2 = 0; n_c2 < m_lengths[1]; n_c2++)
           {
-            unit c2 = m_grids[1][i_c2];
+            const int i_c2 = InPlace ? m_sweep_order[1][n_c2] : n_c2;
+            if (m_axes[1].steps_to_goal(i_c2, i_v2) > max_steps)
+            {
+              stats->skipped_states += m_lengths[2];
+              continue;
+            }
+            unit c2 = m_grids[1].value_at(i_c2);
+            const float lower_bound_c2 = lower_bound_c1 + m_axes[1].cost_lower_bound(i_c2, i_v2);
 
-            for (int i = 0; i < NUM_INPUTS; i++)
-              for (int j = 0; j < m_num_disturbances; j++)
-              {
-                new_c2s[i][j] = c2 + new_v2s[i][j] * m_delta_time;
-                i_new_c2s[i][j] = m_grids[1].search(new_c2s[i][j]);
-              }
+            for (size_t a = 0; a < num_successors; a++)
+              new_c2s[a] = c2 + new_v2s[a] * m_delta_time;
+            m_grids[1].search_integral<STEP_SIZE>(new_c2s, i_new_c2s, num_successors);
 
             // z coordinate
-            for (int i_c3 = 0; i_c3 < m_lengths[2]; i_c3++)
+            for (int n_c3 = 0; n_c3 < m_lengths[2]; n_c3++)
             {
-              unit c3 = m_grids[2][i_c3];
-
-              for (int i = 0; i < NUM_INPUTS; i++)
-                for (int j = 0; j < m_num_disturbances; j++)
+              const int i_c3 = InPlace ? m_sweep_order[2][n_c3] : n_c3;
+              if (m_axes[2].steps_to_goal(i_c3, i_v3) > max_steps)
+              {
+                stats->skipped_states++;
+                continue;
+              }
+              // States beyond the cost bound don't matter for the initial state. In-place sweeps keep their values.
+              if (lower_bound_c2 + m_axes[2].cost_lower_bound(i_c3, i_v3) > cost_bound)
+              {
+                if constexpr (!InPlace)
                 {
-                  new_c3s[i][j] = c3 + new_v3s[i][j] * m_delta_time;
-                  i_new_c3s[i][j] = m_grids[2].search(new_c3s[i][j]);
+                  m_V->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3) = COST_INF;
+                  m_u_opt->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3) = -1;
                 }
+                stats->skipped_states++;
+                continue;
+              }
+              unit c3 = m_grids[2].value_at(i_c3);
 
-              bool any_valid = false;
-              for (int i = 0; i < NUM_INPUTS; i++)
-                for (int j = 0; j < m_num_disturbances; j++)
-                {
-                  bool v = true;
-                  v &= i_new_v1s[i][j] != -1;
-                  v &= i_new_v2s[i][j] != -1;
-                  v &= i_new_v3s[i][j] != -1;
-                  v &= i_new_c1s[i][j] != -1;
-                  v &= i_new_c2s[i][j] != -1;
-                  v &= i_new_c3s[i][j] != -1;
-                  valid[i][j] = v;
-                  any_valid |= v;
-                }
+              for (size_t a = 0; a < num_successors; a++)
+                new_c3s[a] = c3 + new_v3s[a] * m_delta_time;
+              m_grids[2].search_integral<STEP_SIZE>(new_c3s, i_new_c3s, num_successors);
 
-              //if (i_c1 == 2 && i_c2 == 1 && i_c3 == 4 && i_v1 == 1 && i_v2 == 1 && i_v3 == 4)
-              //{
-              //  int i_dd = 4;
-              //  int timee = 96;
-              //}
+              bool any_valid = false;
+              for (size_t a = 0; a < num_successors; a++)
+              {
+                bool v = true;
+                v &= i_new_v1s[a] != -1;
+                v &= i_new_v2s[a] != -1;
+                v &= i_new_v3s[a] != -1;
+                v &= i_new_c1s[a] != -1;
+                v &= i_new_c2s[a] != -1;
+                v &= i_new_c3s[a] != -1;
+                valid[a] = v;
+                any_valid |= v;
+              }
 
+              cost_t value = COST_INF;
+              int policy = -1;
               if (any_valid)
               {
-                float min_cost_to_go = numeric_limits<float>::max();
+                // Every distinct successor is checked for collisions and read once
+                for (size_t a = 0; a < num_successors; a++)
+                {
+                  blocked[a] = !valid[a];
+                  if (!valid[a])
+                    continue;
+                  CollisionCloud::point3 i_old_c((size_t)i_c1, (size_t)i_c2, (size_t)i_c3);
+                  CollisionCloud::point3 i_new_c((size_t)i_new_c1s[a], (size_t)i_new_c2s[a], (size_t)i_new_c3s[a]);
+                  blocked[a] = m_collision_cloud->will_collide(i_old_c, i_new_c, stats->collisions);
+                  if (blocked[a])
+                    continue;
+                  unit x[6]{ new_c1s[a], new_c2s[a], new_c3s[a], new_v1s[a], new_v2s[a], new_v3s[a] };
+                  in_goal[a] = successor_in_goal<Stretching>(x);
+                  squared_norms[a] = squared_norm(x);
+                  next_costs_to_go[a] = load_value<InPlace>(m_V->at(next_stage, i_new_c1s[a], i_new_c2s[a], i_new_c3s[a], i_new_v1s[a], i_new_v2s[a], i_new_v3s[a]));
+                }
+                float o_cost = 0.f;
+#ifdef INCLUDE_O_IN_COST
+                if constexpr (OCostUsed)
+                  o_cost = (*m_o_cost)[i_c1][i_c2][i_c3];
+#endif
+
+                cost_t min_cost_to_go = COST_INF;
                 int argmin_cost_to_go = -1;
                 for (int i = 0; i < NUM_INPUTS; i++)
                 {
-                  float max_cost_to_go = numeric_limits<float>::lowest();
+                  const int input_norm = accelerations->input_norms[i];
+                  cost_t max_cost_to_go = numeric_limits<cost_t>::lowest();
                   int argmax_cost_to_go = -1;
-                  for (int j = 0; j < m_num_disturbances; j++)
+                  for (int j = 0; j < NumDisturbances; j++)
                   {
-                    float cost_to_go;
-                    if (!valid[i][j])
+                    const int a = accelerations->index[j][i];
+                    cost_t cost_to_go;
+                    if (blocked[a])
                     {
-                      cost_to_go = numeric_limits<float>::max();
+                      cost_to_go = COST_INF;
                     }
                     else
                     {
-                      unit x[6]{ new_c1s[i][j], new_c2s[i][j], new_c3s[i][j], new_v1s[i][j], new_v2s[i][j], new_v3s[i][j] };
-                      CollisionCloud::point3 i_old_c((size_t)i_c1, (size_t)i_c2, (size_t)i_c3);
-                      CollisionCloud::point3 i_new_c((size_t)i_new_c1s[i][j], (size_t)i_new_c2s[i][j], (size_t)i_new_c3s[i][j]);
-                      bool colliding = m_collision_cloud->will_collide(i_old_c, i_new_c);
-                      float running_costs = colliding ? numeric_limits<float>::max() : running_cost(x, inputs[i], i_c1, i_c2, i_c3);
-
-                      float next_cost_to_go = m_V->at(stage + 1, i_new_c1s[i][j], i_new_c2s[i][j], i_new_c3s[i][j], i_new_v1s[i][j], i_new_v2s[i][j], i_new_v3s[i][j]);
-                      cost_to_go = running_costs + next_cost_to_go;
+                      cost_t running_costs = in_goal[a] ? 0 : combine_running_cost<OCostUsed>(input_norm, squared_norms[a], o_cost);
+                      cost_to_go = add_costs(running_costs, next_costs_to_go[a]);
                     }
-                    if (cost_to_go > max_cost_to_go)
+                    // The first disturbance seeds the maximum, because lowest() is a valid cost (0) of integer costs
+                    if (argmax_cost_to_go == -1 || cost_to_go > max_cost_to_go)
                     {
                       max_cost_to_go = cost_to_go;
                       argmax_cost_to_go = j;
@@ -514,30 +928,178 @@ void dynamic_programming::DynamicProgramming::calculate_one_stage_threaded(const
                     argmin_cost_to_go = i;
                   }
                 }
-
-                m_V->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3) = min_cost_to_go;
-                m_u_opt->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3) = argmin_cost_to_go;
-                if (min_cost_to_go < numeric_limits<float>::max())
-                  (*finite_states)++;
+                value = min_cost_to_go;
+                policy = argmin_cost_to_go;
+                if (min_cost_to_go < COST_INF)
+                  stats->finite_states++;
+                stats->evaluated_states++;
               }
               else
               {
-                m_V->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3) = numeric_limits<float>::max();
-                m_u_opt->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3) = -1;
+                stats->skipped_states++;
               }
+              // Change against the stage with one step less or the previous sweep for the fix point criteria.
+              // The terminal stage has no policy.
+              cost_t& stored_value = m_V->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3);
+              int& stored_policy = m_u_opt->at(stage, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3);
+              cost_t previous_value = InPlace ? load_value<InPlace>(stored_value) : m_V->at(stage - 1, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3);
+              int previous_policy = InPlace ? stored_policy : (stage > 1 ? m_u_opt->at(stage - 1, i_c1, i_c2, i_c3, i_v1, i_v2, i_v3) : policy);
+              store_value<InPlace>(stored_value, value);
+              stored_policy = policy;
+
+              bool finite = value < COST_INF;
+              if (finite != (previous_value < COST_INF))
+                stats->max_value_change = numeric_limits<float>::infinity();
+              else if (finite)
+                stats->max_value_change = std::max(stats->max_value_change, relative_value_change(value, previous_value));
+              if (policy != previous_policy)
+                stats->policy_changes++;
             }
           }
         }
       }
     }
   }
+  stats->busy = std::chrono::steady_clock::now() - begin;
 }
 
-bool dynamic_programming::DynamicProgramming::initial_region_is_covered(const long i_time, const int i_x0[6])
+size_t dynamic_programming::DynamicProgramming::evaluate_policy(const unit3* inputs)
+{
+  constexpr bool drag = DRAG_FORCE_COEFFICIENT != 0;
+  constexpr size_t NO_SUCCESSOR = std::numeric_limits<size_t>::max();
+  enum Visit : uint8_t { UNVISITED, IN_PROGRESS, DONE };
+
+  cost_t* values = m_V->data(1);
+  const int* policy = m_u_opt->data(1);
+  const size_t num_states = m_V->slice_size();
+  size_t strides[6]{};
+  strides[5] = 1;
+  for (int i = 4; i >= 0; i--)
+    strides[i] = strides[i + 1] * m_lengths[i + 1];
+
+  // Transitions of one state under its policy. Invalid and colliding transitions have no successor.
+  struct Frame
+  {
+    size_t state;
+    size_t successors[NUM_DISTURBANCES];
+    cost_t running_costs[NUM_DISTURBANCES];
+    int next;
+  };
+  CollisionCloud::Stats collisions;
+  auto expand = [&](const size_t state)
+    {
+      Frame frame{ state, {}, {}, 0 };
+      int i_x[6]{};
+      for (int i = 0; i < 6; i++)
+        i_x[i] = (int)(state / strides[i] % m_lengths[i]);
+      const unit3& input = inputs[policy[state]];
+      for (int j = 0; j < m_num_disturbances; j++)
+      {
+        unit x[6]{};
+        int i_new_x[6]{};
+        bool valid = true;
+        for (int i = 0; i < 3; i++)
+        {
+          unit v = m_grids[i + 3].value_at(i_x[i + 3]);
+          unit acceleration = input[i];
+          if (m_num_disturbances > 1)
+            acceleration += m_disturbances[j][i];
+          if constexpr (drag)
+            acceleration += -DRAG_FORCE_COEFFICIENT * v;
+          x[i + 3] = v + acceleration * m_delta_time;
+          x[i] = m_grids[i].value_at(i_x[i]) + x[i + 3] * m_delta_time;
+          i_new_x[i] = m_grids[i].search_integral<STEP_SIZE>(x[i]);
+          i_new_x[i + 3] = m_grids[i + 3].search_integral<STEP_SIZE>(x[i + 3]);
+          valid &= i_new_x[i] != -1 && i_new_x[i + 3] != -1;
+        }
+        frame.successors[j] = NO_SUCCESSOR;
+        if (!valid)
+          continue;
+        CollisionCloud::point3 i_old_c((size_t)i_x[0], (size_t)i_x[1], (size_t)i_x[2]);
+        CollisionCloud::point3 i_new_c((size_t)i_new_x[0], (size_t)i_new_x[1], (size_t)i_new_x[2]);
+        if (m_collision_cloud->will_collide(i_old_c, i_new_c, collisions))
+          continue;
+#ifdef INCLUDE_O_IN_COST
+        bool o_cost_used = m_o_cost_used;
+#else
+        bool o_cost_used = false;
+#endif
+        if (m_stretching)
+          frame.running_costs[j] = o_cost_used ? running_cost<true, true>(x, input, i_x[0], i_x[1], i_x[2]) : running_cost<true, false>(x, input, i_x[0], i_x[1], i_x[2]);
+        else
+          frame.running_costs[j] = o_cost_used ? running_cost<false, true>(x, input, i_x[0], i_x[1], i_x[2]) : running_cost<false, false>(x, input, i_x[0], i_x[1], i_x[2]);
+        size_t successor = 0;
+        for (int i = 0; i < 6; i++)
+          successor += strides[i] * i_new_x[i];
+        frame.successors[j] = successor;
+      }
+      return frame;
+    };
+  auto evaluated = [&](const size_t state)
+    {
+      return policy[state] >= 0 && values[state] < COST_INF;
+    };
+
+  std::vector<uint8_t> visits(num_states, UNVISITED);
+  std::vector<Frame> stack;
+  size_t lowered = 0;
+  for (size_t root = 0; root < num_states; root++)
+  {
+    if (visits[root] != UNVISITED || !evaluated(root))
+      continue;
+    visits[root] = IN_PROGRESS;
+    stack.push_back(expand(root));
+    while (!stack.empty())
+    {
+      Frame& frame = stack.back();
+      if (frame.next < m_num_disturbances)
+      {
+        size_t successor = frame.successors[frame.next++];
+        if (successor != NO_SUCCESSOR && visits[successor] == UNVISITED && evaluated(successor))
+        {
+          visits[successor] = IN_PROGRESS;
+          stack.push_back(expand(successor));
+        }
+        continue;
+      }
+
+      // All successors are evaluated, except those on a cycle
+      cost_t value = numeric_limits<cost_t>::lowest();
+      for (int j = 0; j < m_num_disturbances; j++)
+      {
+        cost_t cost_to_go = frame.successors[j] == NO_SUCCESSOR ? COST_INF : add_costs(frame.running_costs[j], values[frame.successors[j]]);
+        value = std::max(value, cost_to_go);
+      }
+      if (value < values[frame.state])
+      {
+        values[frame.state] = value;
+        lowered++;
+      }
+      visits[frame.state] = DONE;
+      stack.pop_back();
+    }
+  }
+  return lowered;
+}
+
+bool dynamic_programming::DynamicProgramming::initial_region_is_covered(const long steps_to_go, const int i_x0[6])
 {
   auto& initial_region = get_initial_region(i_x0);
+  if (m_separable)
+  {
+    if (!m_axes[0].is_calculated(steps_to_go))
+      return false;
+    for (auto& tuple : initial_region)
+    {
+      const int i_x[6]{ std::get<0>(tuple), std::get<1>(tuple), std::get<2>(tuple), std::get<3>(tuple), std::get<4>(tuple), std::get<5>(tuple) };
+      for (int i = 0; i < 3; i++)
+        if (m_axes[i].value(steps_to_go, i_x[i], i_x[i + 3]) >= std::numeric_limits<float>::max())
+          return false;
+    }
+    return true;
+  }
   for (auto& tuple : initial_region)
-    if (m_V->at(i_time, std::get<0>(tuple), std::get<1>(tuple), std::get<2>(tuple), std::get<3>(tuple), std::get<4>(tuple), std::get<5>(tuple)) >= std::numeric_limits<float>::max())
+    if (m_V->at(steps_to_go, std::get<0>(tuple), std::get<1>(tuple), std::get<2>(tuple), std::get<3>(tuple), std::get<4>(tuple), std::get<5>(tuple)) >= COST_INF)
       return false;
   return true;
 }
@@ -571,8 +1133,7 @@ std::vector<std::tuple<int, int, int, int, int, int>>& dynamic_programming::Dyna
 
 size_t dynamic_programming::DynamicProgramming::fill_terminal_costs()
 {
-  Config& config = Config::get_instance();
-  int stages = config.get<int>(Config::Key::NUMBER_OF_STAGES);
+  m_V->allocate(0);
   size_t count = 0;
   for (int c1 = 0; c1 < m_lengths[0]; c1++)
   {
@@ -586,10 +1147,10 @@ size_t dynamic_programming::DynamicProgramming::fill_terminal_costs()
           {
             for (int v3 = 0; v3 < m_lengths[5]; v3++)
             {
-              const unit x[6]{ m_grids[0][c1], m_grids[1][c2], m_grids[2][c3], m_grids[3][v1], m_grids[4][v2], m_grids[5][v3] };
-              float c = terminal_cost(x);
-              m_V->at(stages - 1, c1, c2, c3, v1, v2, v3) = c;
-              if (c == 0.f)
+              const unit x[6]{ m_grids[0].value_at(c1), m_grids[1].value_at(c2), m_grids[2].value_at(c3), m_grids[3].value_at(v1), m_grids[4].value_at(v2), m_grids[5].value_at(v3) };
+              cost_t c = terminal_cost(x);
+              m_V->at(0, c1, c2, c3, v1, v2, v3) = c;
+              if (c == 0)
                 count++;
             }
           }
@@ -599,3 +1160,394 @@ size_t dynamic_programming::DynamicProgramming::fill_terminal_costs()
   }
   return count;
 }
+
+dynamic_programming::ObstacleWorld::Region dynamic_programming::DynamicProgramming::get_region() const
+{
+  // Obstacles further away than MIN_DISTANCE_TO_COLLISION can't collide with any transition inside the box.
+  // With collision costs, obstacles within the cost radius still contribute to o_cost.
+  unit margin = (unit)ceil(CollisionCloud::MIN_DISTANCE_TO_COLLISION / STEP_SIZE);
+  if (m_settings.collision_cost_factor != 0.f)
+    margin = std::max(margin, (unit)m_settings.collision_cost_radius);
+  return ObstacleWorld::Region
+  {
+    m_origin,
+    m_stretch_factor,
+    unit3(m_grids[0].get_begin(), m_grids[1].get_begin(), m_grids[2].get_begin()),
+    unit3(m_grids[0].get_end(), m_grids[1].get_end(), m_grids[2].get_end()),
+    margin
+  };
+}
+
+bool dynamic_programming::DynamicProgramming::can_warm_start(const Range old_grids[6]) const
+{
+  if (!m_settings.warm_start_retries || m_settings.use_single_stage_controller || m_last_computed_steps < 0)
+    return false;
+  for (int i = 0; i < 6; i++)
+  {
+    if (old_grids[i].get_step() != m_grids[i].get_step()
+      || old_grids[i].get_begin() < m_grids[i].get_begin() || old_grids[i].get_end() > m_grids[i].get_end())
+      return false;
+  }
+  return true;
+}
+
+size_t dynamic_programming::DynamicProgramming::apply_warm_start()
+{
+  const size_t* l = m_warm_start.lengths;
+  size_t o[6]{};
+  for (int i = 0; i < 6; i++)
+    o[i] = (m_warm_start.grids[i].get_begin() - m_grids[i].get_begin()) / STEP_SIZE;
+
+  // The old values are an upper bound of the cost-to-go, because their trajectories are possible in the new box, too
+  size_t count = 0;
+  size_t j = 0;
+  for (size_t c1 = 0; c1 < l[0]; c1++)
+    for (size_t c2 = 0; c2 < l[1]; c2++)
+      for (size_t c3 = 0; c3 < l[2]; c3++)
+        for (size_t v1 = 0; v1 < l[3]; v1++)
+          for (size_t v2 = 0; v2 < l[4]; v2++)
+            for (size_t v3 = 0; v3 < l[5]; v3++)
+            {
+              cost_t value = m_warm_start.values[j++];
+              cost_t& terminal = m_V->at(0, c1 + o[0], c2 + o[1], c3 + o[2], v1 + o[3], v2 + o[4], v3 + o[5]);
+              if (value < terminal)
+                terminal = value;
+              if (terminal < COST_INF)
+                count++;
+            }
+  std::vector<cost_t>().swap(m_warm_start.values);
+  return count;
+}
+
+std::string dynamic_programming::DynamicProgramming::Footprint::to_string() const
+{
+  const double MB = 1024. * 1024.;
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(1)
+    << "value function " << value_function / MB << " MB, policy " << policy / MB << " MB, o_cost " << o_cost / MB
+    << " MB, collision memo " << collision_memo / MB << " MB, total " << total() / MB << " MB";
+  return stream.str();
+}
+
+dynamic_programming::DynamicProgramming::Footprint dynamic_programming::DynamicProgramming::estimate_footprint(const size_t lengths[6], const int stages)
+{
+  size_t num_states = 1;
+  for (int i = 0; i < 6; i++)
+    num_states *= lengths[i];
+  size_t num_cells = lengths[0] * lengths[1] * lengths[2];
+  return Footprint
+  {
+    stages * num_states * sizeof(cost_t),
+    stages * num_states * sizeof(int),
+#ifdef INCLUDE_O_IN_COST
+    num_cells * sizeof(float),
+#else
+    0,
+#endif
+    // Memo of every pair of cells
+    num_cells * num_cells * sizeof(int8_t)
+  };
+}
+
+dynamic_programming::DynamicProgramming::Footprint dynamic_programming::DynamicProgramming::admit(const size_t num_states)
+{
+  m_number_of_stages = m_settings.number_of_stages;
+  m_max_number_of_stages = std::max(m_settings.number_of_stages, m_settings.max_number_of_stages);
+  // Stationary solvers only store the terminal and the stationary stage, however many sweeps they need
+  const bool in_place = m_settings.solver != Settings::JACOBI;
+  Footprint footprint = estimate_footprint(m_lengths, in_place ? MIN_NUMBER_OF_STAGES : m_number_of_stages);
+  BOOST_LOG_TRIVIAL(debug) << "Estimated memory footprint: " << footprint.to_string();
+  if (m_settings.memory_limit_mb <= 0)
+    return footprint;
+
+  // Only value function and policy grow with the horizon
+  const size_t limit = (size_t)m_settings.memory_limit_mb * 1024 * 1024;
+  Footprint one_stage = estimate_footprint(m_lengths, 1);
+  size_t fixed = one_stage.o_cost + one_stage.collision_memo;
+  size_t per_stage = one_stage.value_function + one_stage.policy;
+  size_t fitting_stages = fixed < limit ? (limit - fixed) / per_stage : 0;
+  if (!in_place)
+    m_max_number_of_stages = (int)std::min((size_t)m_max_number_of_stages, fitting_stages);
+  if (footprint.total() <= limit)
+    return footprint;
+
+  if (fitting_stages < MIN_NUMBER_OF_STAGES)
+  {
+    std::stringstream report;
+    report << std::fixed << std::setprecision(1) << "Memory limit of " << m_settings.memory_limit_mb << " MB is exceeded by "
+      << num_states << " states per stage (" << footprint.to_string() << "). Even " << MIN_NUMBER_OF_STAGES
+      << " stages don't fit: collision memo and o_cost need " << fixed / (1024. * 1024.) << " MB and every stage needs "
+      << per_stage / (1024. * 1024.) << " MB. Use a smaller state space or raise memory_limit_mb.";
+    BOOST_LOG_TRIVIAL(error) << report.str();
+    throw std::length_error(report.str());
+  }
+
+  BOOST_LOG_TRIVIAL(warning) << "Estimated memory footprint of " << footprint.total() / (1024 * 1024) << " MB exceeds memory_limit_mb of "
+    << m_settings.memory_limit_mb << " MB. Reducing the horizon from " << m_number_of_stages << " to " << fitting_stages << " stages.";
+  m_number_of_stages = (int)fitting_stages;
+  return estimate_footprint(m_lengths, m_number_of_stages);
+}
+
+void dynamic_programming::DynamicProgramming::allocate_stage(const long steps_to_go)
+{
+  bool allocated = m_V->is_allocated(steps_to_go);
+  m_V->allocate(steps_to_go);
+  m_u_opt->allocate(steps_to_go);
+  if (allocated || !m_pruning)
+    return;
+
+  // The kernel skips pruned states without writing them, so every new stage marks them once
+
+  cost_t* values = m_V->data(steps_to_go);
+  int* policy = m_u_opt->data(steps_to_go);
+  size_t i_state = 0;
+  for (size_t c1 = 0; c1 < m_lengths[0]; c1++)
+    for (size_t c2 = 0; c2 < m_lengths[1]; c2++)
+      for (size_t c3 = 0; c3 < m_lengths[2]; c3++)
+        for (size_t v1 = 0; v1 < m_lengths[3]; v1++)
+          for (size_t v2 = 0; v2 < m_lengths[4]; v2++)
+            for (size_t v3 = 0; v3 < m_lengths[5]; v3++, i_state++)
+            {
+              const size_t i_x[6]{ c1, c2, c3, v1, v2, v3 };
+              if (!is_pruned(i_x, steps_to_go))
+                continue;
+              values[i_state] = COST_INF;
+              policy[i_state] = -1;
+            }
+}
+
+std::vector<dynamic_programming::unit> dynamic_programming::DynamicProgramming::get_input_components(const int axis) const
+{
+  std::vector<unit> components;
+  for (int k = 0; k < NUM_INPUTS; k++)
+  {
+    components.push_back(m_smaller_inputs[k][axis]);
+    components.push_back(m_larger_inputs[k][axis]);
+  }
+  std::sort(components.begin(), components.end());
+  components.erase(std::unique(components.begin(), components.end()), components.end());
+  return components;
+}
+
+size_t dynamic_programming::DynamicProgramming::calculate_feasible_states()
+{
+  size_t feasible_states = 1;
+  for (int i = 0; i < 3; i++)
+  {
+    // With a single disturbance only the zero disturbance is applied
+    std::vector<unit> disturbances;
+    for (int j = 0; j < m_num_disturbances; j++)
+      disturbances.push_back(m_num_disturbances > 1 ? m_disturbances[j][i] : 0);
+    std::sort(disturbances.begin(), disturbances.end());
+    disturbances.erase(std::unique(disturbances.begin(), disturbances.end()), disturbances.end());
+    feasible_states *= m_axes[i].calculate_feasible_states(get_input_components(i), disturbances);
+  }
+  return feasible_states;
+}
+
+bool dynamic_programming::DynamicProgramming::is_pruned(const size_t i_x[6], const long steps_to_go) const
+{
+  const int max_steps = m_time_pruning ? (int)steps_to_go : AxisProblem::UNREACHABLE - 1;
+  for (int i = 0; i < 3; i++)
+    if (m_axes[i].steps_to_goal(i_x[i], i_x[i + 3]) > max_steps)
+      return true;
+  return false;
+}
+
+long dynamic_programming::DynamicProgramming::storage_stage(const long steps_to_go) const
+{
+  // The axis problems keep every stage, because they are small
+  return m_settings.solver != Settings::JACOBI && !m_separable ? std::min(steps_to_go, 1L) : steps_to_go;
+}
+
+void dynamic_programming::DynamicProgramming::calculate_sweep_order()
+{
+  for (int i = 0; i < 6; i++)
+  {
+    Range goal = m_goal_space.get_range(i);
+    float goal_begin = (float)goal.get_begin() / m_stretch_factor[i % 3];
+    float goal_end = (float)goal.get_end() / m_stretch_factor[i % 3];
+    auto distance = [&](const int index)
+      {
+        float value = (float)m_grids[i].value_at(index);
+        return std::max({ goal_begin - value, value - goal_end, 0.f });
+      };
+
+    m_sweep_order[i].resize(m_lengths[i]);
+    std::iota(m_sweep_order[i].begin(), m_sweep_order[i].end(), 0);
+    std::stable_sort(m_sweep_order[i].begin(), m_sweep_order[i].end(), [&](const int a, const int b) { return distance(a) < distance(b); });
+  }
+}
+
+bool dynamic_programming::DynamicProgramming::extend_horizon(const int i_x0[6], const size_t last_stage_finite_states, const int finite_states_changed)
+{
+  if (m_number_of_stages >= m_max_number_of_stages)
+    return false;
+  // Further stages can't help if the initial region is reached already, if nothing reaches the goal or if the set of states has converged.
+  // Stationary solvers sweep until their values converge, which calculate_controller checks after every sweep.
+  const long last_steps = m_number_of_stages - 1;
+  if ((m_settings.solver == Settings::JACOBI || m_separable)
+    && (initial_region_is_covered(storage_stage(last_steps), i_x0) || last_stage_finite_states == 0 || finite_states_changed >= 2))
+    return false;
+
+  int old_number_of_stages = m_number_of_stages;
+  m_number_of_stages = std::min(m_number_of_stages + HORIZON_CHUNK, m_max_number_of_stages);
+  Tracer::get_instance().instant("extend_horizon", "dp", Tracer::Args().add("from", old_number_of_stages).add("to", m_number_of_stages));
+  BOOST_LOG_TRIVIAL(debug) << "Extending the horizon from " << old_number_of_stages << " to " << m_number_of_stages << " stages.";
+  return true;
+}
+
+long dynamic_programming::DynamicProgramming::calculate_separable_controller(const int i_x0[6], const std::chrono::steady_clock::time_point& total_begin)
+{
+  notify_phase_started("terminal_costs");
+  BOOST_LOG_TRIVIAL(debug) << "### final stage ###";
+  size_t terminal_states = 1;
+  {
+    TraceSpan span("terminal_costs", "dp");
+    for (AxisProblem& axis : m_axes)
+      terminal_states *= axis.fill_terminal_costs();
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Number of states in goal space: " << terminal_states;
+
+  size_t num_states = 1;
+  for (const AxisProblem& axis : m_axes)
+    num_states *= axis.num_states();
+
+  int finite_states_changed = 0;
+  size_t last_finite_states = 0;
+  size_t last_stage_finite_states = 0;
+  std::vector<std::chrono::nanoseconds> stage_durations;
+
+  BOOST_LOG_TRIVIAL(debug) << "### recursive calculation of optimal cost-to-go of the axes ###";
+  long last_steps = 0;
+  for (long steps = 1; ; steps++)
+  {
+    if (steps >= m_number_of_stages && !extend_horizon(i_x0, last_stage_finite_states, finite_states_changed))
+      break;
+    const long i_time = m_number_of_stages - 1 - steps;
+
+    notify_phase_started("stage", i_time);
+    TraceSpan stage_span("stage", "dp", Tracer::Args().add("stage", i_time));
+    std::chrono::steady_clock::time_point stage_begin = std::chrono::steady_clock::now();
+
+    // A 6D state has a finite value if every axis has one, and a valid successor if every axis has one, because the
+    // inputs are the product of the components. Its optimal input is unchanged if no component changed.
+    const unit3* inputs = steps + 1 > INPUTS_SMALLER_STAGES ? m_larger_inputs : m_smaller_inputs;
+    size_t finite_states = 1;
+    size_t evaluated_states = 1;
+    size_t unchanged_policies = 1;
+    float max_value_change = 0.f;
+    for (int i = 0; i < 3; i++)
+    {
+      // create_inputs ends with the largest component of every axis
+      AxisProblem::StageStats stats = m_axes[i].calculate_stage(steps, inputs[NUM_INPUTS - 1][i]);
+      finite_states *= stats.finite_states;
+      evaluated_states *= stats.evaluated_states;
+      unchanged_policies *= m_axes[i].num_states() - stats.policy_changes;
+      max_value_change = std::max(max_value_change, stats.max_value_change);
+    }
+    size_t skipped_states = num_states - evaluated_states;
+    bool policies_comparable = steps > 1 && (steps > INPUTS_SMALLER_STAGES) == (steps + 1 > INPUTS_SMALLER_STAGES);
+    size_t policy_changes = policies_comparable ? num_states - unchanged_policies : 0;
+
+    std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - stage_begin;
+    stage_durations.push_back(duration);
+    last_stage_finite_states = finite_states;
+    last_steps = steps;
+
+    // The axes are solved on the calling thread without collision checks
+    const size_t no_collisions = 0;
+    std::vector<std::chrono::nanoseconds> thread_busy{ duration };
+    std::vector<std::chrono::nanoseconds> thread_idle{ std::chrono::nanoseconds(0) };
+    PerfCounters::Values perf;
+    std::vector<PerfCounters::Values> thread_perf(1);
+    RuntimeLogger::DpStageFinishedEvent stage_event
+    {
+      i_time,
+      duration,
+      finite_states,
+      evaluated_states,
+      skipped_states,
+      no_collisions,
+      no_collisions,
+      no_collisions,
+      max_value_change,
+      policy_changes,
+      thread_busy,
+      thread_idle,
+      perf,
+      thread_perf
+    };
+    if (m_runtime_logger != nullptr)
+      m_runtime_logger->dp_stage_finished(stage_event);
+    BOOST_LOG_TRIVIAL(debug) << "Stage " << i_time << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms. Number of states with finite cost-to-go: " << finite_states;
+
+    if (finite_states == last_finite_states)
+      finite_states_changed++;
+    else
+      finite_states_changed = 0;
+
+    // Same criteria as the 6D calculation. The value change is the largest one of the axes.
+    if (finite_states_changed == 2)
+    {
+      BOOST_LOG_TRIVIAL(debug) << "Number of finite cost states hasn't changed in three stages. Fix point has probably been reached.";
+      if (m_break_on_norm_fixpoint_reached)
+        break;
+    }
+    if ((m_settings.enable_value_fix_point || m_settings.solver != Settings::JACOBI) && max_value_change <= m_settings.value_fix_point_tolerance)
+    {
+      BOOST_LOG_TRIVIAL(debug) << "Values changed by at most " << max_value_change << " in the last stage. Value function has converged.";
+      break;
+    }
+    if (m_settings.enable_policy_fix_point && policies_comparable
+      && policy_changes <= m_settings.policy_fix_point_tolerance * num_states)
+    {
+      BOOST_LOG_TRIVIAL(debug) << policy_changes << " states changed their optimal input in the last stage. Policy has converged.";
+      break;
+    }
+    if (initial_region_is_covered(steps, i_x0))
+    {
+      BOOST_LOG_TRIVIAL(debug) << "Initial region is covered. Shortest path has been calculated.";
+      if (m_break_on_initial_region_covered_fixpoint_reached)
+        break;
+    }
+
+    last_finite_states = finite_states;
+  }
+
+  // The 6D value function isn't calculated, so a retry can't be warm started from it
+  m_last_computed_steps = -1;
+
+  RuntimeLogger::DpFinishedEvent event
+  {
+    std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - total_begin),
+    std::chrono::duration_cast<std::chrono::milliseconds>(stage_durations[0]),
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::accumulate(stage_durations.begin(), stage_durations.end(), std::chrono::nanoseconds(0)) / stage_durations.size()),
+    stage_durations.size(),
+    last_stage_finite_states
+  };
+  if (m_runtime_logger != nullptr)
+    m_runtime_logger->dp_finished(event);
+
+  if (initial_region_is_covered(last_steps, i_x0))
+  {
+    BOOST_LOG_TRIVIAL(debug) << "Initial region is covered.";
+    return m_number_of_stages - 1 - last_steps;
+  }
+  else
+  {
+    BOOST_LOG_TRIVIAL(debug) << "Initial region is not covered.";
+    return -1;
+  }
+}
+
+void dynamic_programming::DynamicProgramming::notify_phase_started(const std::string& phase, const long stage)
+{
+  RuntimeLogger::DpPhaseStartedEvent event
+  {
+    phase,
+    stage
+  };
+  if (m_runtime_logger != nullptr)
+    m_runtime_logger->dp_phase_started(event);
+}
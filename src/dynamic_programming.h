@@ -1,19 +1,29 @@
 #pragma once
 
+#include "axis_problem.h"
 #include "collision_cloud.h"
 #include "consts.h"
 #include "matrix.h"
+#include "obstacle_world.h"
+#include "perf_counters.h"
 #include "range.h"
 #include "state_space.h"
+#include "tracer.h"
 #include "config.h"
 #include <boost/log/trivial.hpp>
+#include <algorithm>
 #include <array>
-#include <array>
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <limits>
 #include <math.h>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <tuple>
 
@@ -22,6 +32,8 @@
 namespace dynamic_programming {
   class DynamicProgramming
   {
+    friend class MicroBenchmark;
+
     static const int INITIAL_REGION_RADIUS = 0;
 
     static const long INPUTS_SMALLER_STAGES = 100;
@@ -34,18 +46,102 @@ namespace dynamic_programming {
       {
         const size_t& num_states;
         const bool retry;
+        /// <summary>
+        /// Estimated bytes of the structures allocated by reinitialize
+        /// </summary>
+        const size_t& estimated_bytes;
+        /// <summary>
+        /// Number of stages after admission control. It is smaller than the configured number if the memory limit required it.
+        /// </summary>
+        const int& num_stages;
       };
       struct DpFinishedEvent
       {
         const std::chrono::seconds& total_duration;
         const std::chrono::milliseconds& first_stage_duration;
         const std::chrono::milliseconds& avg_stage_duration;
+        const size_t& num_stages;
+        const size_t& finite_states;
+      };
+      struct DpStageFinishedEvent
+      {
+        const long& stage;
+        const std::chrono::nanoseconds& duration;
+        const size_t& finite_states;
+        /// <summary>
+        /// States with at least one valid successor that aren't pruned as infeasible. The others are skipped and get infinite costs.
+        /// </summary>
+        const size_t& evaluated_states;
+        const size_t& skipped_states;
+        const size_t& collision_checks;
+        const size_t& collision_memo_hits;
+        const size_t& obstacles_scanned;
+        /// <summary>
+        /// Largest change of a value against the stage with one step less, relative to max(1, |previous value|).
+        /// It is infinite if a state changed between finite and infinite cost.
+        /// </summary>
+        const float& max_value_change;
+        /// <summary>
+        /// States whose optimal input differs from the stage with one step less. 0 if the policies aren't comparable.
+        /// </summary>
+        const size_t& policy_changes;
+        /// <summary>
+        /// Time every worker thread spent in the kernel and the rest of the stage duration
+        /// </summary>
+        const std::vector<std::chrono::nanoseconds>& thread_busy;
+        const std::vector<std::chrono::nanoseconds>& thread_idle;
+        /// <summary>
+        /// Hardware counters of the stage and of every worker thread. All counters are unavailable if perf_counters is off.
+        /// </summary>
+        const PerfCounters::Values& perf;
+        const std::vector<PerfCounters::Values>& thread_perf;
+      };
+      struct DpPhaseStartedEvent
+      {
+        const std::string& phase;
+        const long& stage;
       };
       virtual void dp_started(const DpStartedEvent& event) = 0;
       virtual void dp_finished(const DpFinishedEvent& event) = 0;
+      /// <summary>
+      /// Called when the calculation enters a phase: reinitialize, terminal_costs, o_cost, stage or policy_evaluation.
+      /// The stage is the index of the stage in the stage phase and -1 otherwise.
+      /// </summary>
+      virtual void dp_phase_started(const DpPhaseStartedEvent& event) { (void)event; }
+      virtual void dp_stage_finished(const DpStageFinishedEvent& event) { (void)event; }
+    };
+
+    /// <summary>
+    /// Bytes of the structures that reinitialize allocates for a state space
+    /// </summary>
+    struct Footprint
+    {
+      size_t value_function;
+      size_t policy;
+      size_t o_cost;
+      size_t collision_memo;
+
+      size_t total() const { return value_function + policy + o_cost + collision_memo; }
+
+      std::string to_string() const;
     };
 
-    DynamicProgramming(const StateSpace& state_space, const StateSpace& goal_space, const unit delta_time, const unit3 stretch_factor, std::function<unit3(const unit3&)> world_to_dp_coordinates, RuntimeLogger* logger);
+    /// <summary>
+    /// Smallest horizon that admission control reduces the number of stages to
+    /// </summary>
+    static const int MIN_NUMBER_OF_STAGES = 2;
+
+    /// <summary>
+    /// Number of stages the horizon grows by if the initial region isn't covered at its end
+    /// </summary>
+    static const int HORIZON_CHUNK = 10;
+
+    /// <summary>
+    /// Estimates the footprint of a DP with the given grid lengths and number of stages before anything is allocated
+    /// </summary>
+    static Footprint estimate_footprint(const size_t lengths[6], const int stages);
+
+    DynamicProgramming(const StateSpace& state_space, const StateSpace& goal_space, const unit delta_time, const unit3 stretch_factor, const unit3& origin, const ObstacleWorld& world, const Settings& settings, RuntimeLogger* logger);
     ~DynamicProgramming();
 
     void set_runtime_logger(RuntimeLogger* runtime_logger)
@@ -59,43 +155,218 @@ namespace dynamic_programming {
 
     const unit3 get_control(const float x[6], long i_time) const;
 
+    int get_number_of_stages() const { return m_number_of_stages; }
+
   private:
-    float terminal_cost(const unit x[6]) const;
+    /// <summary>
+    /// Checks the estimated footprint against the memory limit of the settings and reduces the horizon if needed.
+    /// Throws std::length_error with a report if even MIN_NUMBER_OF_STAGES don't fit.
+    /// </summary>
+    Footprint admit(const size_t num_states);
+
+    /// <summary>
+    /// Allocates value function and policy of the stage with the given number of steps to go.
+    /// A newly allocated stage gets infinite costs and no input in the pruned states, which the stage kernel skips.
+    /// </summary>
+    void allocate_stage(const long steps_to_go);
+
+    /// <summary>
+    /// Input components of an axis in both input sets, because the stages use both
+    /// </summary>
+    std::vector<unit> get_input_components(const int axis) const;
 
-    float running_cost(const unit x[6], const unit3 &input, const int i_c1, const int i_c2, const int i_c3) const;
+    /// <summary>
+    /// Calculates the feasible states of every axis for both input sets and all disturbances and returns the number
+    /// of 6D states that aren't pruned
+    /// </summary>
+    size_t calculate_feasible_states();
 
-    void calculate_one_stage_threaded(const long stage, const size_t start_i_v1, const size_t end_i_v1, size_t* finite_states, const unit3* inputs);
+    /// <summary>
+    /// A 6D state with fewer steps to go than one of its axes needs to reach its goal has infinite cost
+    /// </summary>
+    bool is_pruned(const size_t i_x[6], const long steps_to_go) const;
 
-    static const size_t NUM_THREADS = 16;
+    /// <summary>
+    /// Stage of m_V and m_u_opt that holds the given number of steps to go. The stationary solvers keep every sweep in stage 1.
+    /// </summary>
+    long storage_stage(const long steps_to_go) const;
 
-    bool initial_region_is_covered(const long i_time, const int i_x0[6]);
+    /// <summary>
+    /// Sorts the indices of every axis by their distance to the goal, so that an in-place sweep visits states near
+    /// the goal first and states further out already see their updated values
+    /// </summary>
+    void calculate_sweep_order();
+
+    /// <summary>
+    /// Grows the horizon by HORIZON_CHUNK stages up to the maximum number of stages if the initial region isn't covered
+    /// at its end and further stages can still change the value function. Stationary solvers always grow it, because
+    /// only their value fix point ends the sweeps. Returns false if the horizon wasn't extended.
+    /// </summary>
+    bool extend_horizon(const int i_x0[6], const size_t last_stage_finite_states, const int finite_states_changed);
+
+    /// <summary>
+    /// Calculates the controller of a separable leg from the three axis problems instead of the 6D stages.
+    /// Stops by the same criteria as the 6D calculation and reports 6D counts to the runtime logger.
+    /// </summary>
+    long calculate_separable_controller(const int i_x0[6], const std::chrono::steady_clock::time_point& total_begin);
+
+    /// <summary>
+    /// Minimum of the calculated stages of the value function of the previous calculation.
+    /// reinitialize keeps it, so that a retry on an enlarged state space doesn't start from the terminal costs alone.
+    /// </summary>
+    struct WarmStart
+    {
+      Range grids[6];
+      size_t lengths[6]{};
+      std::vector<cost_t> values;
+    };
+
+    /// <summary>
+    /// A retry can be warm started if the new grid contains the old one. The seeded terminal stage is no longer the goal,
+    /// so a warm start is only valid for the stationary controller, i.e. without use_single_stage_controller.
+    /// </summary>
+    bool can_warm_start(const Range old_grids[6]) const;
+
+    /// <summary>
+    /// Lowers the terminal costs to the kept values of the previous calculation and returns the number of seeded states with finite cost
+    /// </summary>
+    size_t apply_warm_start();
+
+    cost_t terminal_cost(const unit x[6]) const;
+
+    template <bool Stretching, bool OCostUsed>
+    cost_t running_cost(const unit x[6], const unit3 &input, const int i_c1, const int i_c2, const int i_c3) const;
+
+    /// <summary>
+    /// Parts of running_cost. It is 0 if the successor is in the goal and combine_running_cost otherwise.
+    /// </summary>
+    template <bool Stretching>
+    bool successor_in_goal(const unit x[6]) const;
+
+    static int squared_norm(const unit x[6]);
+
+    template <bool OCostUsed>
+    cost_t combine_running_cost(const int input_norm, const int squared_norm, const float o_cost) const;
+
+    /// <summary>
+    /// Distinct total accelerations of an input set under the disturbances. Several pairs of input and disturbance add up
+    /// to the same acceleration, so the stage kernel evaluates every distinct successor once and maps the pairs to it.
+    /// </summary>
+    struct AccelerationSet
+    {
+      size_t size = 0;
+      unit3 accelerations[NUM_INPUTS * NUM_DISTURBANCES]{};
+      /// <summary>
+      /// Index into accelerations, indexed [disturbance][input]
+      /// </summary>
+      int index[NUM_DISTURBANCES][NUM_INPUTS]{};
+      /// <summary>
+      /// Squared norm of every input, which is its part of the running cost
+      /// </summary>
+      int input_norms[NUM_INPUTS]{};
+    };
+
+    static AccelerationSet create_acceleration_set(const unit3* inputs, const unit3* disturbances, const int num_disturbances);
+
+    /// <summary>
+    /// Counters of one worker thread in one stage
+    /// </summary>
+    struct StageStats
+    {
+      size_t finite_states = 0;
+      size_t evaluated_states = 0;
+      size_t skipped_states = 0;
+      CollisionCloud::Stats collisions;
+      float max_value_change = 0.f;
+      size_t policy_changes = 0;
+      std::chrono::nanoseconds busy{ 0 };
+      PerfCounters::Values perf;
+    };
+
+    /// <summary>
+    /// Calculates the given stage from the one with one step less for the x velocities [start_i_v1, end_i_v1).
+    /// InPlace updates the stage from itself in the sweep order instead and accesses values atomically, because
+    /// other workers read them concurrently.
+    /// Properties that don't change during a run are template parameters, so that every combination gets its own
+    /// kernel without runtime checks in the innermost loops.
+    /// </summary>
+    template <bool Stretching, bool OCostUsed, size_t NumDisturbances, bool Drag, bool InPlace>
+    void calculate_one_stage_threaded(const long stage, const size_t start_i_v1, const size_t end_i_v1, StageStats* stats, const AccelerationSet* accelerations);
+
+    typedef void (DynamicProgramming::*StageKernel)(const long stage, const size_t start_i_v1, const size_t end_i_v1, StageStats* stats, const AccelerationSet* accelerations);
+
+    StageKernel select_stage_kernel() const;
+
+    /// <summary>
+    /// Evaluates the policy of the stationary stage in place. Trajectories of finite cost strictly approach the goal,
+    /// so the fixed-policy transitions form an acyclic graph that one depth-first pass evaluates in successor order.
+    /// Successors on a cycle keep their current value. Values are only lowered. Returns the number of lowered values.
+    /// </summary>
+    size_t evaluate_policy(const unit3* inputs);
+
+    bool initial_region_is_covered(const long steps_to_go, const int i_x0[6]);
 
     std::vector<std::tuple<int, int, int, int, int, int>>& get_initial_region(const int i_x0[6]);
 
     size_t fill_terminal_costs();
 
+    ObstacleWorld::Region get_region() const;
+
+    void notify_phase_started(const std::string& phase, const long stage = -1);
+
     RuntimeLogger* m_runtime_logger = nullptr;
-    int m_num_disturbances = Config::get_instance().get(Config::DISTURBANCE_ON) == "true" ? NUM_DISTURBANCES : 1;
+    StageKernel m_stage_kernel = nullptr;
+    const Settings m_settings;
+    int m_number_of_stages = 0;
+    int m_max_number_of_stages = 0;
+    const int m_num_disturbances;
     const int* m_i_x0 = nullptr;
     std::vector<std::tuple<int, int, int, int, int, int>> m_initial_region;
     Range m_grids[6];
     size_t m_lengths[6];
-    matrix<float>* m_V = nullptr;
+    std::vector<int> m_sweep_order[6];
+    /// <summary>
+    /// Value function and policy indexed by the number of steps to go, so that the horizon can grow. 0 is the terminal stage.
+    /// </summary>
+    matrix<cost_t>* m_V = nullptr;
     matrix<int>* m_u_opt = nullptr;
 #ifdef INCLUDE_O_IN_COST
     boost::multi_array<float, 3>* m_o_cost = nullptr;
-    bool m_o_cost_used;
+    bool m_o_cost_used = false;
 #endif
     const StateSpace& m_state_space;
     const StateSpace& m_goal_space;
     const float m_delta_time;
     CollisionCloud* m_collision_cloud = nullptr;
-    std::function<unit3(unit3)> m_world_to_dp_coordinates;
+    const ObstacleWorld& m_world;
+    const unit3 m_origin;
     const unit3 m_stretch_factor;
     const bool m_stretching = false;
     unit3 m_smaller_inputs[NUM_INPUTS]{};
     unit3 m_larger_inputs[NUM_INPUTS]{};
+    AccelerationSet m_smaller_accelerations;
+    AccelerationSet m_larger_accelerations;
     unit3 m_disturbances[NUM_DISTURBANCES]{};
+    /// <summary>
+    /// A leg without obstacles and disturbances is separable if separable_legs is on. Its value function is the sum of
+    /// the values of the axis problems and its optimal input is composed of their optimal components.
+    /// </summary>
+    bool m_separable = false;
+    /// <summary>
+    /// States whose projection on one of the axes is infeasible are pruned from the 6D stages
+    /// </summary>
+    bool m_pruning = false;
+    /// <summary>
+    /// Stages are also pruned by the steps to the goal. Only the stages of Jacobi without a warm start start from the goal.
+    /// </summary>
+    bool m_time_pruning = false;
+    /// <summary>
+    /// Best value of the initial state so far if enable_cost_bound is on. States whose lower bound exceeds it are skipped.
+    /// </summary>
+    cost_t m_cost_bound = COST_INF;
+    std::vector<AxisProblem> m_axes;
+    WarmStart m_warm_start;
+    long m_last_computed_steps = -1;
     bool m_break_on_initial_region_covered_fixpoint_reached;
     bool m_break_on_norm_fixpoint_reached;
   };
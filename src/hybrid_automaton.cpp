@@ -45,10 +45,9 @@ const dynamic_programming::unit3 dynamic_programming::HybridAutomaton::Starting:
       goal_space,
       delta_time(),
       unit3::ONE(),
-      [point](const unit3& world_point)
-      {
-        return unit3(world_point.x - point.x, world_point.y - point.y, world_point.z - point.z);
-      },
+      point,
+      m_ha->m_world,
+      m_ha->m_settings,
       m_ha->m_dp_logger
     );
     long calculation_stopped_at = -1;
@@ -166,10 +165,9 @@ const dynamic_programming::unit3 dynamic_programming::HybridAutomaton::Cruising:
       goal_space,
       delta_time(),
       stretch_factor,
-      [point](const unit3& world_point)
-      {
-        return unit3(world_point.x - point.x, world_point.y - point.y, world_point.z - point.z);
-      },
+      point,
+      m_ha->m_world,
+      m_ha->m_settings,
       m_ha->m_dp_logger
     );
     long calculation_stopped_at = -1;
@@ -285,10 +283,9 @@ const dynamic_programming::unit3 dynamic_programming::HybridAutomaton::Landing::
       goal_space,
       delta_time(),
       unit3::ONE(),
-      [point](const unit3& world_point)
-      {
-        return unit3(world_point.x - point.x, world_point.y - point.y, world_point.z - point.z);
-      },
+      point,
+      m_ha->m_world,
+      m_ha->m_settings,
       m_ha->m_dp_logger
     );
     long calculation_stopped_at = -1;
@@ -360,8 +357,8 @@ dynamic_programming::StateSpace dynamic_programming::HybridAutomaton::Landing::g
   };
 }
 
-dynamic_programming::HybridAutomaton::HybridAutomaton(const std::vector<unit3>& route, DynamicProgramming::RuntimeLogger* dp_logger)
-  : m_state(new Starting(this)), m_route(route), m_dp_logger(dp_logger)
+dynamic_programming::HybridAutomaton::HybridAutomaton(const std::vector<unit3>& route, const ObstacleWorld& world, const Settings& settings, DynamicProgramming::RuntimeLogger* dp_logger)
+  : m_state(new Starting(this)), m_dp_logger(dp_logger), m_route(route), m_world(world), m_settings(settings), m_disturbance_controller(settings)
 {
   validate_route();
   for (int i = 0; i < 3; i++)
@@ -373,13 +370,14 @@ dynamic_programming::HybridAutomaton::HybridAutomaton(const std::vector<unit3>&
 
 void dynamic_programming::HybridAutomaton::run_once()
 {
+  TraceSpan span("step", "simulation");
   float delta_time_sim = m_state->delta_time() / R;
   m_state->do_flow(delta_time_sim);
   m_minor_time_counter++;
   if (m_minor_time_counter >= R)
   {
     m_minor_time_counter = 0;
-    if (Config::get_instance().get(Config::USE_SINGLE_STAGE_CONTROLLER) == "true")
+    if (m_settings.use_single_stage_controller)
       m_major_time_counter++;
   }
   if(!m_state->invariant_holds())
@@ -473,6 +471,7 @@ void dynamic_programming::HybridAutomaton::notify_state_changed(const State* old
     old_goal_space,
     new_time
   };
+  Tracer::get_instance().instant("state_changed", "ha", Tracer::Args().add("old", old_state->name()).add("new", new_state->name()));
   for (EventListener* listener : m_listeners)
     listener->on_state_changed(event);
 }
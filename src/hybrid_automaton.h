@@ -3,8 +3,10 @@
 #include "consts.h"
 #include "disturbance_controller.h"
 #include "dynamic_programming.h"
+#include "obstacle_world.h"
 #include "stretch_utils.h"
 #include "state_space.h"
+#include "tracer.h"
 #include <boost/log/trivial.hpp>
 #include <functional>
 #include <stdexcept>
@@ -101,7 +103,7 @@ namespace dynamic_programming
       virtual void on_x_changed(const XChangedEvent& event) = 0;
     };
 
-    HybridAutomaton(const std::vector<unit3>& route, DynamicProgramming::RuntimeLogger* dp_logger);
+    HybridAutomaton(const std::vector<unit3>& route, const ObstacleWorld& world, const Settings& settings, DynamicProgramming::RuntimeLogger* dp_logger);
 
     ~HybridAutomaton()
     {
@@ -118,6 +120,10 @@ namespace dynamic_programming
 
     const std::vector<unit3>& get_route() const { return m_route; }
 
+    const ObstacleWorld& get_obstacle_world() const { return m_world; }
+
+    const Settings& get_settings() const { return m_settings; }
+
   private:
     static unit get_delta_time(const State& state);
 
@@ -139,8 +145,10 @@ namespace dynamic_programming
     float m_x[6]{};
     double m_time = 0.;
     const std::vector<unit3>& m_route;
+    const ObstacleWorld& m_world;
+    const Settings m_settings;
     size_t m_route_counter = 0u;
-    DynamicProgramming* m_dynamic_programming;
+    DynamicProgramming* m_dynamic_programming = nullptr;
     long m_major_time_counter = 0;
     long m_minor_time_counter = 0;
     std::vector<EventListener*> m_listeners = std::vector<EventListener*>();
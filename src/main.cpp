@@ -16,6 +16,8 @@ int main(int argc, char* argv[])
     return -1;
   }
 
+  const Settings settings = config.get_settings();
+
   // Create output directory
   std::string out_dir = get_output_directory(config.get(Config::Key::DESCRIPTION));
 
@@ -25,20 +27,124 @@ int main(int argc, char* argv[])
   // Save config to file
   config.save_to_file(out_dir + "config.txt");
 
-  // Copy route and collision cloud to output directory
-  std::filesystem::copy(config.get(Config::Key::ROUTE_FILE), out_dir + "route.txt");
-  std::filesystem::copy(config.get(Config::Key::COLLISION_CLOUD_FILE), out_dir + "collision_cloud.txt");
+  // Run micro benchmark of the DP hot paths instead of a route
+  if (config.get(Config::Key::BENCHMARK) == "micro")
+  {
+    try
+    {
+      MicroBenchmark benchmark(settings, config.get<int>(Config::Key::BENCHMARK_GRID_LENGTH), config.get<int>(Config::Key::BENCHMARK_REPETITIONS));
+      benchmark.run_all();
+      benchmark.write_json(out_dir + "micro_benchmark.json");
+    }
+    catch (const std::invalid_argument& e)
+    {
+      BOOST_LOG_TRIVIAL(fatal) << "Micro benchmark failed: " << e.what();
+      return -1;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Done.";
+    return 0;
+  }
+
+  // Run the stage sweep with growing thread counts
+  if (config.get(Config::Key::BENCHMARK) == "scaling")
+  {
+    try
+    {
+      ScalingBenchmark benchmark(settings, config.get<int>(Config::Key::BENCHMARK_GRID_LENGTH), config.get<int>(Config::Key::BENCHMARK_REPETITIONS), config.get<int>(Config::Key::BENCHMARK_MAX_THREADS));
+      benchmark.run_all();
+      benchmark.write_csv(out_dir + "scaling_benchmark.csv");
+    }
+    catch (const std::invalid_argument& e)
+    {
+      BOOST_LOG_TRIVIAL(fatal) << "Scaling benchmark failed: " << e.what();
+      return -1;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Done.";
+    return 0;
+  }
+
+  // Run all scenarios headless and compare with the baseline
+  if (config.get(Config::Key::BENCHMARK) == "scenarios")
+  {
+    bool passed = false;
+    try
+    {
+      ScenarioBenchmark benchmark(settings, "scenarios", ScenarioBenchmark::split(config.get(Config::Key::BENCHMARK_SCENARIOS)), ScenarioBenchmark::split(config.get(Config::Key::BENCHMARK_CONFIGS)));
+      benchmark.run_all();
+      benchmark.write_csv(out_dir + "scenario_benchmark.csv");
+      // A missing baseline fails the comparison, so writing or skipping it has to be asked for
+      std::string baseline_mode = config.get(Config::Key::BENCHMARK_BASELINE_MODE);
+      if (baseline_mode == "write")
+      {
+        benchmark.write_csv(config.get(Config::Key::BENCHMARK_BASELINE));
+        BOOST_LOG_TRIVIAL(info) << "Benchmark: wrote baseline " << config.get(Config::Key::BENCHMARK_BASELINE);
+        passed = true;
+      }
+      else if (baseline_mode == "skip")
+      {
+        BOOST_LOG_TRIVIAL(info) << "Benchmark: skipping comparison with the baseline";
+        passed = true;
+      }
+      else
+      {
+        passed = benchmark.compare_with_baseline(config.get(Config::Key::BENCHMARK_BASELINE), config.get<float>(Config::Key::BENCHMARK_TOLERANCE));
+      }
+    }
+    catch (const std::invalid_argument& e)
+    {
+      BOOST_LOG_TRIVIAL(fatal) << "Scenario benchmark failed: " << e.what();
+      return -1;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Done.";
+    return passed ? 0 : 1;
+  }
+
+  // Copy route and collision cloud to output directory. Binary scenario files keep their extension.
+  auto copy_name = [](const std::string& path, const std::string& name)
+    {
+      return name + (ScenarioFile::is_scenario_file(path) ? std::filesystem::path(path).extension().string() : ".txt");
+    };
+  std::filesystem::copy(config.get(Config::Key::ROUTE_FILE), out_dir + copy_name(config.get(Config::Key::ROUTE_FILE), "route"));
+  std::filesystem::copy(config.get(Config::Key::COLLISION_CLOUD_FILE), out_dir + copy_name(config.get(Config::Key::COLLISION_CLOUD_FILE), "collision_cloud"));
 
   // Load route
   vector<unit3> route = get_route(config.get(Config::Key::ROUTE_FILE));
 
 
+  // Trace the whole mission if requested
+  Tracer& tracer = Tracer::get_instance();
+  if (config.get<bool>(Config::Key::TRACE))
+  {
+    tracer.start();
+    tracer.set_thread_lane(0, "main");
+  }
+
   // Run hybrid automaton
   try
   {
-    DpStats dp_stats(out_dir);
+    DpStats dp_stats(out_dir, std::chrono::milliseconds(config.get<int>(Config::Key::RESOURCE_SAMPLE_INTERVAL_MS)));
+    RuntimeLoggerGroup runtime_loggers;
+    runtime_loggers.add(&dp_stats);
 
-    HybridAutomaton hybrid_automaton = HybridAutomaton(route, &dp_stats);
+    // Per stage telemetry
+    std::unique_ptr<StageTelemetrySink> jsonl_sink;
+    std::unique_ptr<StageTelemetrySink> csv_sink;
+    std::string stage_telemetry = config.get(Config::Key::STAGE_TELEMETRY);
+    if (stage_telemetry == "jsonl" || stage_telemetry == "both")
+    {
+      jsonl_sink = std::make_unique<JsonLinesStageSink>(out_dir);
+      runtime_loggers.add(jsonl_sink.get());
+    }
+    if (stage_telemetry == "csv" || stage_telemetry == "both")
+    {
+      csv_sink = std::make_unique<CsvStageSink>(out_dir);
+      runtime_loggers.add(csv_sink.get());
+    }
+
+    // Load obstacles once for all legs
+    ObstacleWorld world(config.get(Config::Key::COLLISION_CLOUD_FILE));
+
+    HybridAutomaton hybrid_automaton = HybridAutomaton(route, world, settings, &runtime_loggers);
     DroneLogger logger(&hybrid_automaton);
     logger.log_to_file(out_dir + "log.txt");
     DronePlotter plotter(&hybrid_automaton, out_dir);
@@ -55,6 +161,19 @@ int main(int argc, char* argv[])
     BOOST_LOG_TRIVIAL(fatal) << "Unexpected error: " << boost::current_exception_diagnostic_information() << std::endl;
   }
 
+  if (tracer.enabled())
+  {
+    tracer.stop();
+    try
+    {
+      tracer.write(out_dir + "trace.json");
+    }
+    catch (const std::invalid_argument& e)
+    {
+      BOOST_LOG_TRIVIAL(error) << "Writing trace failed: " << e.what();
+    }
+  }
+
   BOOST_LOG_TRIVIAL(info) << "Done.";
   return 0;
 }
@@ -68,7 +187,15 @@ std::vector<unit3> dynamic_programming::get_route(const std::string path)
 {
   std::vector<unit3> route;
 
-  if (true)
+  if (ScenarioFile::is_scenario_file(path))
+  {
+    // Binary scenario file
+    ScenarioFile scenario(path);
+    route.reserve(scenario.num_route_points());
+    for (size_t i = 0; i < scenario.num_route_points(); i++)
+      route.push_back(scenario.route_point(i));
+  }
+  else if (true)
   {
     ifstream file(path);
     if (file.is_open())
@@ -4,9 +4,16 @@
 #include "drone_plotter.h"
 #include "dynamic_programming.h"
 #include "hybrid_automaton.h"
+#include "micro_benchmark.h"
+#include "obstacle_world.h"
 #include "range.h"
+#include "scaling_benchmark.h"
+#include "scenario_benchmark.h"
+#include "scenario_file.h"
 #include "config.h"
 #include "dp_stats.h"
+#include "runtime_logger_group.h"
+#include "stage_telemetry.h"
 #include <boost/log/trivial.hpp>
 #include <boost/log/utility/setup/file.hpp>
 #include <boost/log/utility/setup/console.hpp>
@@ -17,10 +24,15 @@
 #include <filesystem>
 #include <iterator>
 #include <vector>
+#ifdef _WIN32
+#include "windows.h"
+#endif
 
 namespace dynamic_programming
 {
+#ifdef _WIN32
   BOOL WINAPI CtrlHandler(DWORD fdwCtrlType);
+#endif
 
   std::vector<unit3> get_route(const std::string path);
 
@@ -1,64 +1,90 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <numeric>
 #include <vector>
 #include <stdexcept>
 
 namespace dynamic_programming {
 
+  /// <summary>
+  /// 7D array whose first dimension (the stage) is allocated slice by slice on demand,
+  /// so that the first dimension can grow and slices that are never used are never allocated.
+  /// </summary>
   template <typename T>
   class matrix {
   public:
-    matrix(const long dim0, const size_t dim1, const size_t dim2, const size_t dim3, const size_t dim4, const size_t dim5, const size_t dim6) :
+    matrix(const size_t dim1, const size_t dim2, const size_t dim3, const size_t dim4, const size_t dim5, const size_t dim6) :
       m_dim0(dim1* dim2* dim3* dim4* dim5* dim6),
       m_dim1(dim2* dim3* dim4* dim5* dim6),
       m_dim2(dim3* dim4* dim5* dim6),
       m_dim3(dim4* dim5* dim6),
       m_dim4(dim5* dim6),
       m_dim5(dim6),
-      m_dim6(1),
-      m_nelem(dim0* dim1* dim2* dim3* dim4* dim5* dim6)
+      m_dim6(1)
     {
-      if (dim0 <= 0)
-        throw std::invalid_argument("dim0 can't be 0 or smaller");
-      m_data = new T[m_nelem];
+      if (m_dim0 == 0)
+        throw std::invalid_argument("dimensions can't be 0");
     }
 
-    ~matrix()
+    /// <summary>
+    /// Allocates the slice dim0 if it isn't allocated yet. Its values are uninitialized.
+    /// </summary>
+    void allocate(const long dim0)
     {
-      delete[] m_data;
+      if (dim0 < 0)
+        throw std::invalid_argument("dim0 can't be smaller than 0");
+      if ((size_t)dim0 >= m_slices.size())
+        m_slices.resize(dim0 + 1);
+      if (m_slices[dim0] == nullptr)
+        m_slices[dim0] = std::unique_ptr<T[]>(new T[m_dim0]);
     }
 
-    const T& at(int i) const
+    bool is_allocated(const long dim0) const
     {
-      return m_data[i];
+      return dim0 >= 0 && (size_t)dim0 < m_slices.size() && m_slices[dim0] != nullptr;
     }
 
-    T& at(int i)
+    /// <summary>
+    /// Number of slices the first dimension has been grown to
+    /// </summary>
+    size_t size() const
     {
-      return m_data[i];
+      return m_slices.size();
+    }
+
+    const T* data(const long dim0) const
+    {
+      return m_slices[dim0].get();
+    }
+
+    T* data(const long dim0)
+    {
+      return m_slices[dim0].get();
     }
 
     const T& at(const long dim0, const size_t dim1, const size_t dim2, const size_t dim3, const size_t dim4, const size_t dim5, const size_t dim6) const
     {
-      size_t flat_index = m_dim0 * dim0 + m_dim1 * dim1 + m_dim2 * dim2 + m_dim3 * dim3 + m_dim4 * dim4 + m_dim5 * dim5 + m_dim6 * dim6;
-      return m_data[flat_index];
+      size_t flat_index = m_dim1 * dim1 + m_dim2 * dim2 + m_dim3 * dim3 + m_dim4 * dim4 + m_dim5 * dim5 + m_dim6 * dim6;
+      return m_slices[dim0][flat_index];
     }
 
     T& at(const long dim0, const size_t dim1, const size_t dim2, const size_t dim3, const size_t dim4, const size_t dim5, const size_t dim6)
     {
-      size_t flat_index = m_dim0 * dim0 + m_dim1 * dim1 + m_dim2 * dim2 + m_dim3 * dim3 + m_dim4 * dim4 + m_dim5 * dim5 + m_dim6 * dim6;
-      return m_data[flat_index];
+      size_t flat_index = m_dim1 * dim1 + m_dim2 * dim2 + m_dim3 * dim3 + m_dim4 * dim4 + m_dim5 * dim5 + m_dim6 * dim6;
+      return m_slices[dim0][flat_index];
     }
 
-    size_t nelem() const
+    /// <summary>
+    /// Number of elements of one slice
+    /// </summary>
+    size_t slice_size() const
     {
-      return m_nelem;
+      return m_dim0;
     }
 
   private:
-    size_t m_nelem;
     size_t m_dim0;
     size_t m_dim1;
     size_t m_dim2;
@@ -66,6 +92,6 @@ namespace dynamic_programming {
     size_t m_dim4;
     size_t m_dim5;
     size_t m_dim6;
-    T* m_data;
+    std::vector<std::unique_ptr<T[]>> m_slices;
   };
-}
\ No newline at end of file
+}
@@ -0,0 +1,252 @@
+#include "micro_benchmark.h"
+
+double dynamic_programming::MicroBenchmark::Result::mean_ns() const
+{
+  double sum = 0.;
+  for (double d : durations_ns)
+    sum += d;
+  return sum / durations_ns.size();
+}
+
+double dynamic_programming::MicroBenchmark::Result::stddev_ns() const
+{
+  if (durations_ns.size() < 2)
+    return 0.;
+  double mean = mean_ns();
+  double sum = 0.;
+  for (double d : durations_ns)
+    sum += (d - mean) * (d - mean);
+  return std::sqrt(sum / (durations_ns.size() - 1));
+}
+
+double dynamic_programming::MicroBenchmark::Result::min_ns() const
+{
+  double min = durations_ns.front();
+  for (double d : durations_ns)
+    min = std::min(min, d);
+  return min;
+}
+
+dynamic_programming::MicroBenchmark::MicroBenchmark(const Settings& settings, const int grid_length, const int repetitions)
+  : m_settings(settings), m_grid_length(grid_length), m_repetitions(repetitions)
+{
+  if (grid_length < 5)
+    throw std::invalid_argument("Grid length of the micro benchmark must be at least 5");
+  if (repetitions < 1)
+    throw std::invalid_argument("Micro benchmark needs at least one repetition");
+}
+
+void dynamic_programming::MicroBenchmark::run_all()
+{
+  m_results.clear();
+  bench_search();
+  bench_will_collide();
+  bench_running_cost();
+  bench_fill_terminal_costs();
+  bench_stage();
+}
+
+void dynamic_programming::MicroBenchmark::write_json(const std::string& path) const
+{
+  std::ofstream out(path);
+  if (!out.is_open())
+    throw std::invalid_argument("Could not open file " + path);
+
+  out << "{" << std::endl;
+  out << "  \"grid_length\": " << m_grid_length << "," << std::endl;
+  out << "  \"repetitions\": " << m_repetitions << "," << std::endl;
+  out << "  \"disturbance_on\": " << (m_settings.disturbance_on ? "true" : "false") << "," << std::endl;
+  out << "  \"benchmarks\": [" << std::endl;
+  for (size_t i = 0; i < m_results.size(); i++)
+  {
+    const Result& r = m_results[i];
+    out << "    { \"name\": \"" << r.name << "\""
+      << ", \"states\": " << r.states
+      << ", \"mean_ns\": " << r.mean_ns()
+      << ", \"stddev_ns\": " << r.stddev_ns()
+      << ", \"min_ns\": " << r.min_ns()
+      << ", \"ns_per_state\": " << r.ns_per_state()
+      << ", \"states_per_s\": " << r.states_per_s()
+      << " }" << (i + 1 < m_results.size() ? "," : "") << std::endl;
+  }
+  out << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
+
+void dynamic_programming::MicroBenchmark::measure(const std::string& name, const size_t states, const std::function<void()>& f, const std::function<void()>& setup)
+{
+  Result result{ name, states };
+  // The first run is a warm up and isn't recorded
+  for (int i = -1; i < m_repetitions; i++)
+  {
+    if (setup)
+      setup();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    f();
+    std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - begin;
+    if (i >= 0)
+      result.durations_ns.push_back((double)duration.count());
+  }
+  BOOST_LOG_TRIVIAL(info) << name << ": " << result.ns_per_state() << " ns/state, " << result.states_per_s() << " states/s (mean "
+    << result.mean_ns() / 1e6 << " ms, stddev " << result.stddev_ns() / 1e6 << " ms, " << states << " states)";
+  m_results.push_back(result);
+}
+
+void dynamic_programming::MicroBenchmark::bench_stage()
+{
+  Settings settings = m_settings;
+  settings.number_of_stages = 2;
+  ObstacleWorld world(get_obstacles());
+  DynamicProgramming dp(get_state_space(), get_goal_space(), DELTA_TIME, unit3::ONE(), unit3::ZERO(), world, settings, nullptr);
+  dp.fill_terminal_costs();
+  dp.allocate_stage(1);
+
+  size_t num_states = 1;
+  for (int i = 0; i < 6; i++)
+    num_states *= dp.m_lengths[i];
+
+  // Single threaded, so that the result is the cost of the kernel itself
+  measure("calculate_one_stage_threaded", num_states, [&]()
+    {
+      DynamicProgramming::StageStats stats;
+      (dp.*dp.m_stage_kernel)(1, 0, dp.m_lengths[3], &stats, &dp.m_smaller_accelerations);
+      m_sink = m_sink + stats.finite_states;
+    });
+}
+
+void dynamic_programming::MicroBenchmark::bench_will_collide()
+{
+  const int l = m_grid_length;
+  const int h = m_grid_length / 2;
+  CollisionCloud cloud(l, l, l, STEP_SIZE);
+  for (const unit3& obstacle : get_obstacles())
+    cloud.add_collision(CollisionCloud::point3(obstacle.x + h, obstacle.y + h, obstacle.z + h));
+
+  // All moves of up to two cells per axis that stay inside the grid
+  std::vector<std::pair<CollisionCloud::point3, CollisionCloud::point3>> moves;
+  for (int x = 0; x < l; x++)
+    for (int y = 0; y < l; y++)
+      for (int z = 0; z < l; z++)
+        for (int dx = -2; dx <= 2; dx++)
+          for (int dy = -2; dy <= 2; dy++)
+            for (int dz = -2; dz <= 2; dz++)
+              if (x + dx >= 0 && x + dx < l && y + dy >= 0 && y + dy < l && z + dz >= 0 && z + dz < l)
+                moves.push_back(std::make_pair(CollisionCloud::point3(x, y, z), CollisionCloud::point3(x + dx, y + dy, z + dz)));
+
+  auto query_all = [&]()
+    {
+      size_t collisions = 0;
+      for (const auto& move : moves)
+        collisions += cloud.will_collide(move.first, move.second);
+      m_sink = m_sink + collisions;
+    };
+
+  // Empty memo, so every call scans the obstacles
+  measure("will_collide (memo miss)", moves.size(), query_all, [&]() { cloud.reset_will_collide_array(); });
+  // Memo filled by the previous runs
+  measure("will_collide (memo hit)", moves.size(), query_all);
+}
+
+void dynamic_programming::MicroBenchmark::bench_search()
+{
+  const int h = m_grid_length / 2;
+  Range range(-h, STEP_SIZE, h);
+
+  // Values run a few steps past both ends, so that misses are included
+  const size_t count = 1 << 16;
+  std::vector<unit> values(count);
+  std::vector<int> indices(count);
+  for (size_t i = 0; i < count; i++)
+    values[i] = -h - 3 + (unit)(i % (m_grid_length + 6));
+
+  measure("Range::search", count, [&]()
+    {
+      long long sum = 0;
+      for (size_t i = 0; i < count; i++)
+        sum += range.search((float)values[i]);
+      m_sink = m_sink + sum;
+    });
+  measure("Range::search_integral", count, [&]()
+    {
+      range.search_integral<STEP_SIZE>(values.data(), indices.data(), count);
+      m_sink = m_sink + indices[count / 2];
+    });
+}
+
+void dynamic_programming::MicroBenchmark::bench_running_cost()
+{
+  Settings settings = m_settings;
+  settings.number_of_stages = 2;
+  ObstacleWorld world(get_obstacles());
+  DynamicProgramming dp(get_state_space(), get_goal_space(), DELTA_TIME, unit3::ONE(), unit3::ZERO(), world, settings, nullptr);
+
+  size_t num_states = 1;
+  for (int i = 0; i < 6; i++)
+    num_states *= dp.m_lengths[i];
+
+  measure("running_cost", num_states, [&]()
+    {
+      double sum = 0.;
+      int i_input = 0;
+      for (int c1 = 0; c1 < dp.m_lengths[0]; c1++)
+        for (int c2 = 0; c2 < dp.m_lengths[1]; c2++)
+          for (int c3 = 0; c3 < dp.m_lengths[2]; c3++)
+            for (int v1 = 0; v1 < dp.m_lengths[3]; v1++)
+              for (int v2 = 0; v2 < dp.m_lengths[4]; v2++)
+                for (int v3 = 0; v3 < dp.m_lengths[5]; v3++)
+                {
+                  const unit x[6]{ dp.m_grids[0].value_at(c1), dp.m_grids[1].value_at(c2), dp.m_grids[2].value_at(c3), dp.m_grids[3].value_at(v1), dp.m_grids[4].value_at(v2), dp.m_grids[5].value_at(v3) };
+                  sum += dp.running_cost<false, false>(x, dp.m_smaller_inputs[i_input], c1, c2, c3);
+                  i_input = (i_input + 1) % NUM_INPUTS;
+                }
+      m_sink = m_sink + sum;
+    });
+}
+
+void dynamic_programming::MicroBenchmark::bench_fill_terminal_costs()
+{
+  Settings settings = m_settings;
+  settings.number_of_stages = 2;
+  ObstacleWorld world(get_obstacles());
+  DynamicProgramming dp(get_state_space(), get_goal_space(), DELTA_TIME, unit3::ONE(), unit3::ZERO(), world, settings, nullptr);
+
+  size_t num_states = 1;
+  for (int i = 0; i < 6; i++)
+    num_states *= dp.m_lengths[i];
+
+  measure("fill_terminal_costs", num_states, [&]()
+    {
+      m_sink = m_sink + dp.fill_terminal_costs();
+    });
+}
+
+dynamic_programming::StateSpace dynamic_programming::MicroBenchmark::get_state_space() const
+{
+  const unit h = m_grid_length / 2;
+  return
+  {
+    { -h, -h, -h, -3, -3, -3 },
+    { STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE },
+    { h, h, h, 3, 3, 3 }
+  };
+}
+
+dynamic_programming::StateSpace dynamic_programming::MicroBenchmark::get_goal_space() const
+{
+  return
+  {
+    { -1, -1, -1, -1, -1, -1 },
+    { STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE },
+    { 1, 1, 1, 1, 1, 1 }
+  };
+}
+
+std::vector<dynamic_programming::unit3> dynamic_programming::MicroBenchmark::get_obstacles() const
+{
+  // Column of obstacles between the corner and the goal
+  const unit h = m_grid_length / 2;
+  std::vector<unit3> obstacles;
+  for (unit z = -h; z <= h; z++)
+    obstacles.push_back(unit3(h / 2 + 1, h / 2 + 1, z));
+  return obstacles;
+}
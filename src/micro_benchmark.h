@@ -0,0 +1,79 @@
+#pragma once
+
+#include "collision_cloud.h"
+#include "config.h"
+#include "consts.h"
+#include "dynamic_programming.h"
+#include "obstacle_world.h"
+#include "range.h"
+#include "state_space.h"
+#include <boost/log/trivial.hpp>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Microbenchmarks of the DP hot paths on a synthetic fixture, so that a kernel change can be measured in isolation.
+  /// The fixture is a state space with grid_length cells per position axis and velocities in [-3, 3] around the
+  /// origin, with a column of obstacles next to the goal. Every benchmark runs once for warm up and then
+  /// `repetitions` times. Results are written as JSON so that they can be compared across commits.
+  /// </summary>
+  class MicroBenchmark
+  {
+  public:
+    struct Result
+    {
+      std::string name;
+      /// <summary>
+      /// Number of states (or calls) processed per repetition
+      /// </summary>
+      size_t states;
+      std::vector<double> durations_ns;
+
+      double mean_ns() const;
+      double stddev_ns() const;
+      double min_ns() const;
+      double ns_per_state() const { return mean_ns() / states; }
+      double states_per_s() const { return states / (mean_ns() * 1e-9); }
+    };
+
+    MicroBenchmark(const Settings& settings, const int grid_length, const int repetitions);
+
+    void run_all();
+
+    void write_json(const std::string& path) const;
+
+    const std::vector<Result>& get_results() const { return m_results; }
+
+  private:
+    /// <summary>
+    /// Measures f. setup is called before every run and is not measured.
+    /// </summary>
+    void measure(const std::string& name, const size_t states, const std::function<void()>& f, const std::function<void()>& setup = nullptr);
+
+    void bench_stage();
+    void bench_will_collide();
+    void bench_search();
+    void bench_running_cost();
+    void bench_fill_terminal_costs();
+
+    StateSpace get_state_space() const;
+    StateSpace get_goal_space() const;
+    std::vector<unit3> get_obstacles() const;
+
+    const Settings m_settings;
+    const int m_grid_length;
+    const int m_repetitions;
+    std::vector<Result> m_results;
+
+    /// <summary>
+    /// Results of the measured functions are accumulated here, so that the compiler can't drop the calls
+    /// </summary>
+    volatile double m_sink = 0.;
+  };
+}
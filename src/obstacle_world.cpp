@@ -0,0 +1,180 @@
+#include "obstacle_world.h"
+
+dynamic_programming::ObstacleWorld::ObstacleWorld(const std::string& path)
+{
+  load_from_file(path);
+  build_index();
+  BOOST_LOG_TRIVIAL(debug) << "Loaded " << m_obstacles.size() << " obstacles into " << m_cells.size() << " cells from " << path;
+}
+
+dynamic_programming::ObstacleWorld::ObstacleWorld(const std::vector<unit3>& obstacles)
+  : m_obstacles(obstacles)
+{
+  build_index();
+}
+
+void dynamic_programming::ObstacleWorld::query(const unit3& min, const unit3& max, std::vector<unit3>& result) const
+{
+  for (unit cx = cell_of(min.x); cx <= cell_of(max.x); cx++)
+    for (unit cy = cell_of(min.y); cy <= cell_of(max.y); cy++)
+      for (unit cz = cell_of(min.z); cz <= cell_of(max.z); cz++)
+      {
+        auto it = m_cells.find(cell_key(cx, cy, cz));
+        if (it == m_cells.end())
+          continue;
+        for (size_t i = it->second.first; i < it->second.second; i++)
+        {
+          const unit3& p = m_obstacles[i];
+          if (p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z)
+            result.push_back(p);
+        }
+      }
+}
+
+std::vector<dynamic_programming::CollisionCloud::point3> dynamic_programming::ObstacleWorld::get_view(const Region& region) const
+{
+  // World box of the region expanded by the margin. The division by the stretch factor rounds towards zero,
+  // so up to stretch_factor - 1 more world units end up on the outermost indices.
+  unit3 world_min, world_max;
+  for (int i = 0; i < 3; i++)
+  {
+    world_min[i] = region.origin[i] + (region.begin[i] - region.margin * STEP_SIZE) * region.stretch_factor[i] - (region.stretch_factor[i] - 1);
+    world_max[i] = region.origin[i] + (region.end[i] + region.margin * STEP_SIZE) * region.stretch_factor[i] + (region.stretch_factor[i] - 1);
+  }
+  std::vector<unit3> obstacles;
+  query(world_min, world_max, obstacles);
+
+  // Transform into grid indices. Obstacles outside of the box get indices outside of [0, length) instead of
+  // being clamped, so that they keep their real distance to the box.
+  std::vector<CollisionCloud::point3> view;
+  view.reserve(obstacles.size());
+  for (const unit3& world_point : obstacles)
+  {
+    unit3 dp_point = world_point - region.origin;
+    dp_point /= region.stretch_factor;
+    int index[3]{};
+    bool inside = true;
+    for (int i = 0; i < 3; i++)
+    {
+      index[i] = (int)round((float)(dp_point[i] - region.begin[i]) / (float)STEP_SIZE);
+      inside &= index[i] >= -region.margin && index[i] < (int)region.length(i) + region.margin;
+    }
+    if (inside)
+      view.push_back(CollisionCloud::point3(index[0], index[1], index[2]));
+  }
+  return view;
+}
+
+std::shared_ptr<const std::vector<float>> dynamic_programming::ObstacleWorld::get_distance_field(const Region& region) const
+{
+  {
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    auto it = m_distance_fields.find(region);
+    if (it != m_distance_fields.end())
+      return it->second;
+  }
+
+  std::vector<CollisionCloud::point3> view = get_view(region);
+  size_t lx = region.length(0), ly = region.length(1), lz = region.length(2);
+  auto field = std::make_shared<std::vector<float>>(region.num_cells(), std::numeric_limits<float>::max());
+  for (int i_c1 = 0; i_c1 < lx; i_c1++)
+  {
+    for (int i_c2 = 0; i_c2 < ly; i_c2++)
+    {
+      for (int i_c3 = 0; i_c3 < lz; i_c3++)
+      {
+        // Iterate over all obstacles in the view to find the one which is closest to c
+        float min_distance_2 = std::numeric_limits<float>::max();
+        for (const CollisionCloud::point3& collision : view)
+        {
+          CollisionCloud::point3 subtraction(i_c1 - collision.x(), i_c2 - collision.y(), i_c3 - collision.z());
+          float distance_2 = bg::dot_product(subtraction, subtraction);
+          if (distance_2 < min_distance_2)
+            min_distance_2 = distance_2;
+        }
+        (*field)[(i_c1 * ly + i_c2) * lz + i_c3] = min_distance_2;
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+  m_distance_fields[region] = field;
+  return field;
+}
+
+void dynamic_programming::ObstacleWorld::load_from_file(const std::string& path)
+{
+  if (ScenarioFile::is_scenario_file(path))
+  {
+    load_from_scenario_file(path);
+    return;
+  }
+
+  std::ifstream file(path);
+  if (!file.is_open())
+  {
+    std::string err = "Could not open file ";
+    err.append(path);
+    BOOST_LOG_TRIVIAL(error) << err;
+    throw std::invalid_argument(err);
+  }
+
+  std::string line;
+  unit3 collision{};
+  while (std::getline(file, line))
+  {
+    if (line.empty() || line.at(0) == ' ' || line.at(0) == '#')
+      continue;
+    if (line.compare("end") == 0)
+      break;
+    std::string::size_type index = line.find(" ");
+    collision.x = (unit)std::stof(line.substr(0, index));
+    line = line.substr(index + 1);
+    index = line.find(" ");
+    collision.y = (unit)std::stof(line.substr(0, index));
+    collision.z = (unit)std::stof(line.substr(index + 1));
+    m_obstacles.push_back(collision);
+  }
+}
+
+void dynamic_programming::ObstacleWorld::load_from_scenario_file(const std::string& path)
+{
+  ScenarioFile scenario(path);
+  m_obstacles.reserve(scenario.num_points());
+  for (size_t i = 0; i < scenario.num_points(); i++)
+    m_obstacles.push_back(scenario.point(i));
+}
+
+void dynamic_programming::ObstacleWorld::build_index()
+{
+  // Sort obstacles by cell so that every cell is a contiguous range. The sort is stable to keep the file order
+  // within a cell.
+  std::stable_sort(m_obstacles.begin(), m_obstacles.end(), [](const unit3& lhs, const unit3& rhs)
+    {
+      return cell_key(cell_of(lhs.x), cell_of(lhs.y), cell_of(lhs.z)) < cell_key(cell_of(rhs.x), cell_of(rhs.y), cell_of(rhs.z));
+    });
+
+  m_cells.clear();
+  for (size_t i = 0; i < m_obstacles.size(); i++)
+  {
+    long long key = cell_key(cell_of(m_obstacles[i].x), cell_of(m_obstacles[i].y), cell_of(m_obstacles[i].z));
+    auto it = m_cells.find(key);
+    if (it == m_cells.end())
+      m_cells[key] = std::make_pair(i, i + 1);
+    else
+      it->second.second = i + 1;
+  }
+}
+
+dynamic_programming::unit dynamic_programming::ObstacleWorld::cell_of(const unit value)
+{
+  // Round towards negative infinity
+  return value >= 0 ? value / CELL_SIZE : -((-value + CELL_SIZE - 1) / CELL_SIZE);
+}
+
+long long dynamic_programming::ObstacleWorld::cell_key(const unit cx, const unit cy, const unit cz)
+{
+  // 21 bits per axis
+  const long long mask = (1ll << 21) - 1;
+  return ((cx & mask) << 42) | ((cy & mask) << 21) | (cz & mask);
+}
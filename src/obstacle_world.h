@@ -0,0 +1,109 @@
+#pragma once
+
+#include "consts.h"
+#include "collision_cloud.h"
+#include "range.h"
+#include "scenario_file.h"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// All obstacles of a scenario in world coordinates.
+  /// The obstacles are loaded once and are shared by every leg and every retry. After loading, the obstacles
+  /// are immutable. Derived fields are cached per region.
+  /// </summary>
+  class ObstacleWorld
+  {
+  public:
+    /// <summary>
+    /// Box of a dynamic programming instance.
+    /// A world point p is mapped onto the grid index (p - origin) / stretch_factor - begin.
+    /// Obstacles further than margin grid cells away from the box are cropped.
+    /// </summary>
+    struct Region
+    {
+      unit3 origin;
+      unit3 stretch_factor;
+      unit3 begin;
+      unit3 end;
+      unit margin;
+
+      size_t length(const int axis) const
+      {
+        return size_t((end[axis] - begin[axis]) / STEP_SIZE) + 1;
+      }
+
+      size_t num_cells() const
+      {
+        return length(0) * length(1) * length(2);
+      }
+
+      friend bool operator<(const Region& lhs, const Region& rhs)
+      {
+        return std::make_tuple(lhs.origin.x, lhs.origin.y, lhs.origin.z, lhs.stretch_factor.x, lhs.stretch_factor.y, lhs.stretch_factor.z,
+          lhs.begin.x, lhs.begin.y, lhs.begin.z, lhs.end.x, lhs.end.y, lhs.end.z, lhs.margin)
+          < std::make_tuple(rhs.origin.x, rhs.origin.y, rhs.origin.z, rhs.stretch_factor.x, rhs.stretch_factor.y, rhs.stretch_factor.z,
+            rhs.begin.x, rhs.begin.y, rhs.begin.z, rhs.end.x, rhs.end.y, rhs.end.z, rhs.margin);
+      }
+    };
+
+    /// <summary>
+    /// Edge length of the cells of the spatial index in world units.
+    /// </summary>
+    static const unit CELL_SIZE = 8;
+
+    ObstacleWorld() {}
+    ObstacleWorld(const std::string& path);
+    ObstacleWorld(const std::vector<unit3>& obstacles);
+
+    // Delete copy constructor and assignment operator
+    ObstacleWorld(ObstacleWorld const&) = delete;
+    void operator=(ObstacleWorld const&) = delete;
+
+    const std::vector<unit3>& get_obstacles() const { return m_obstacles; }
+
+    void query(const unit3& min, const unit3& max, std::vector<unit3>& result) const;
+
+    std::vector<CollisionCloud::point3> get_view(const Region& region) const;
+
+    std::shared_ptr<const std::vector<float>> get_distance_field(const Region& region) const;
+
+  private:
+    void load_from_file(const std::string& path);
+
+    void load_from_scenario_file(const std::string& path);
+
+    void build_index();
+
+    static unit cell_of(const unit value);
+
+    static long long cell_key(const unit cx, const unit cy, const unit cz);
+
+    /// <summary>
+    /// Obstacles sorted by the cell of the spatial index they belong to
+    /// </summary>
+    std::vector<unit3> m_obstacles;
+
+    /// <summary>
+    /// Maps a cell key onto the range [first, second) of m_obstacles
+    /// </summary>
+    std::unordered_map<long long, std::pair<size_t, size_t>> m_cells;
+
+    mutable std::mutex m_cache_mutex;
+
+    /// <summary>
+    /// Squared distance from every cell of a region to the closest obstacle in that region's view
+    /// </summary>
+    mutable std::map<Region, std::shared_ptr<const std::vector<float>>> m_distance_fields;
+  };
+}
@@ -0,0 +1,133 @@
+#include "perf_counters.h"
+#include <atomic>
+#include <boost/log/trivial.hpp>
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const std::array<std::string, dynamic_programming::PerfCounters::NUM_COUNTERS> dynamic_programming::PerfCounters::COUNTER_NAMES =
+{
+  "cycles",
+  "instructions",
+  "llc_misses",
+  "dtlb_misses",
+  "branch_misses"
+};
+
+/// <summary>
+/// Set once a counter couldn't be opened, so that the failure is logged once and not retried for every thread
+/// </summary>
+static std::atomic<bool> s_unavailable[dynamic_programming::PerfCounters::NUM_COUNTERS]{};
+
+double dynamic_programming::PerfCounters::Values::ipc() const
+{
+  if (!available(CYCLES) || !available(INSTRUCTIONS) || counts[CYCLES] == 0)
+    return -1.;
+  return (double)counts[INSTRUCTIONS] / counts[CYCLES];
+}
+
+dynamic_programming::PerfCounters::Values& dynamic_programming::PerfCounters::Values::operator+=(const Values& rhs)
+{
+  for (int i = 0; i < NUM_COUNTERS; i++)
+  {
+    if (rhs.counts[i] < 0)
+      continue;
+    counts[i] = std::max(counts[i], 0LL) + rhs.counts[i];
+  }
+  return *this;
+}
+
+#ifdef __linux__
+dynamic_programming::PerfCounters::PerfCounters()
+{
+  static const std::pair<uint32_t, uint64_t> EVENTS[NUM_COUNTERS] =
+  {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+  };
+
+  m_fds.fill(-1);
+  for (int i = 0; i < NUM_COUNTERS; i++)
+  {
+    if (s_unavailable[i])
+      continue;
+
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = EVENTS[i].first;
+    attr.config = EVENTS[i].second;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Calling thread on any CPU
+    m_fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (m_fds[i] < 0 && !s_unavailable[i].exchange(true))
+      BOOST_LOG_TRIVIAL(warning) << "Performance counter " << COUNTER_NAMES[i] << " is unavailable: " << std::strerror(errno);
+  }
+}
+
+dynamic_programming::PerfCounters::~PerfCounters()
+{
+  for (int fd : m_fds)
+    if (fd >= 0)
+      close(fd);
+}
+
+void dynamic_programming::PerfCounters::start()
+{
+  for (int fd : m_fds)
+  {
+    if (fd < 0)
+      continue;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+dynamic_programming::PerfCounters::Values dynamic_programming::PerfCounters::stop()
+{
+  Values values;
+  for (int i = 0; i < NUM_COUNTERS; i++)
+  {
+    if (m_fds[i] < 0)
+      continue;
+    ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    // value, time enabled, time running
+    uint64_t data[3]{};
+    if (read(m_fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+      continue;
+    // Scale up if the counter was multiplexed with others
+    values.counts[i] = (long long)((double)data[0] * data[1] / data[2]);
+  }
+  return values;
+}
+#else
+dynamic_programming::PerfCounters::PerfCounters()
+{
+  m_fds.fill(-1);
+  if (!s_unavailable[0].exchange(true))
+    BOOST_LOG_TRIVIAL(warning) << "Performance counters are only supported on Linux";
+}
+
+dynamic_programming::PerfCounters::~PerfCounters()
+{
+}
+
+void dynamic_programming::PerfCounters::start()
+{
+}
+
+dynamic_programming::PerfCounters::Values dynamic_programming::PerfCounters::stop()
+{
+  return Values();
+}
+#endif
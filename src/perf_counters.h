@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Hardware performance counters of the calling thread, read with perf_event_open on Linux.
+  /// Counters that can't be opened (no permission, not supported by the CPU or a VM, other platforms) are reported
+  /// as unavailable instead of failing, so the DP runs the same with and without them.
+  /// </summary>
+  class PerfCounters
+  {
+  public:
+    enum Counter
+    {
+      CYCLES,
+      INSTRUCTIONS,
+      LLC_MISSES,
+      DTLB_MISSES,
+      BRANCH_MISSES,
+      NUM_COUNTERS
+    };
+
+    static const std::array<std::string, NUM_COUNTERS> COUNTER_NAMES;
+
+    /// <summary>
+    /// Counter values. A value of -1 means that the counter is unavailable.
+    /// </summary>
+    struct Values
+    {
+      std::array<long long, NUM_COUNTERS> counts{ -1, -1, -1, -1, -1 };
+
+      bool available(const Counter counter) const { return counts[counter] >= 0; }
+
+      /// <summary>
+      /// Instructions per cycle or -1 if either counter is unavailable
+      /// </summary>
+      double ipc() const;
+
+      /// <summary>
+      /// Sums up available counters. A counter stays unavailable only if it is unavailable on both sides.
+      /// </summary>
+      Values& operator+=(const Values& rhs);
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    // Delete copy constructor and assignment operator
+    PerfCounters(PerfCounters const&) = delete;
+    void operator=(PerfCounters const&) = delete;
+
+    void start();
+
+    Values stop();
+
+  private:
+    std::array<int, NUM_COUNTERS> m_fds;
+  };
+}
@@ -0,0 +1,111 @@
+#include "process_stats.h"
+
+#ifdef _WIN32
+#include "windows.h"
+#include "psapi.h"
+#else
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+size_t dynamic_programming::get_peak_rss()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return 0;
+  return (size_t)pmc.PeakWorkingSetSize;
+#else
+  // VmHWM is reset by reset_peak_rss, ru_maxrss isn't
+  size_t peak_rss = get_resource_usage().peak_rss;
+  if (peak_rss > 0)
+    return peak_rss;
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  // ru_maxrss is in kilobytes on Linux
+  return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+bool dynamic_programming::reset_peak_rss()
+{
+#ifdef _WIN32
+  // The peak working set of a process can't be reset
+  return false;
+#else
+  // Writing 5 to clear_refs resets VmHWM to the current RSS
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  if (!clear_refs.is_open())
+    return false;
+  clear_refs << "5" << std::flush;
+  return clear_refs.good();
+#endif
+}
+
+size_t dynamic_programming::get_current_rss()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return 0;
+  return (size_t)pmc.WorkingSetSize;
+#else
+  // Second field of statm is the number of resident pages
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0, resident = 0;
+  if (!(statm >> size >> resident))
+    return 0;
+  return resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+dynamic_programming::ResourceUsage dynamic_programming::get_resource_usage()
+{
+  ResourceUsage usage{};
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+  {
+    usage.rss = (size_t)pmc.WorkingSetSize;
+    usage.peak_rss = (size_t)pmc.PeakWorkingSetSize;
+  }
+  FILETIME creation, exit, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+  {
+    // FILETIME counts 100 ns intervals
+    usage.user_cpu_us = (int64_t)((((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime) / 10);
+    usage.sys_cpu_us = (int64_t)((((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) / 10);
+  }
+#else
+  // Lines look like "VmRSS:     1234 kB"
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    std::string::size_type colon = line.find(':');
+    if (colon == std::string::npos)
+      continue;
+    std::string key = line.substr(0, colon);
+    int64_t value = std::strtoll(line.c_str() + colon + 1, nullptr, 10);
+    if (key == "VmRSS")
+      usage.rss = (size_t)value * 1024;
+    else if (key == "VmHWM")
+      usage.peak_rss = (size_t)value * 1024;
+    else if (key == "voluntary_ctxt_switches")
+      usage.voluntary_context_switches = value;
+    else if (key == "nonvoluntary_ctxt_switches")
+      usage.involuntary_context_switches = value;
+  }
+  struct rusage rusage;
+  if (getrusage(RUSAGE_SELF, &rusage) == 0)
+  {
+    usage.user_cpu_us = (int64_t)rusage.ru_utime.tv_sec * 1000000 + rusage.ru_utime.tv_usec;
+    usage.sys_cpu_us = (int64_t)rusage.ru_stime.tv_sec * 1000000 + rusage.ru_stime.tv_usec;
+  }
+#endif
+  return usage;
+}
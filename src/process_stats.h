@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Resource usage of the whole process at one point in time. Values that can't be determined on a platform are 0.
+  /// </summary>
+  struct ResourceUsage
+  {
+    size_t rss;
+    size_t peak_rss;
+    /// <summary>
+    /// CPU time in user and kernel mode, in microseconds
+    /// </summary>
+    int64_t user_cpu_us;
+    int64_t sys_cpu_us;
+    int64_t voluntary_context_switches;
+    int64_t involuntary_context_switches;
+
+    friend ResourceUsage operator-(const ResourceUsage& lhs, const ResourceUsage& rhs)
+    {
+      // Memory is a level, not a counter, so it isn't subtracted
+      return ResourceUsage
+      {
+        lhs.rss,
+        lhs.peak_rss,
+        lhs.user_cpu_us - rhs.user_cpu_us,
+        lhs.sys_cpu_us - rhs.sys_cpu_us,
+        lhs.voluntary_context_switches - rhs.voluntary_context_switches,
+        lhs.involuntary_context_switches - rhs.involuntary_context_switches
+      };
+    }
+  };
+
+  /// <summary>
+  /// Peak resident set size of the process in bytes since it started or since the last reset_peak_rss,
+  /// or 0 if it can't be determined.
+  /// </summary>
+  size_t get_peak_rss();
+
+  /// <summary>
+  /// Resets the peak resident set size to the current one, so that the peak of a single phase can be measured.
+  /// Returns false if the platform can't reset it. Then the peak stays the one since the process started.
+  /// </summary>
+  bool reset_peak_rss();
+
+  /// <summary>
+  /// Current resident set size of the process in bytes, or 0 if it can't be determined.
+  /// </summary>
+  size_t get_current_rss();
+
+  /// <summary>
+  /// Memory, CPU time and context switches of the process.
+  /// On Linux memory and context switches come from /proc/self/status and CPU times from getrusage.
+  /// On Windows there are no context switch counters.
+  /// </summary>
+  ResourceUsage get_resource_usage();
+}
@@ -26,6 +26,14 @@ namespace dynamic_programming {
 
     const unit operator[](const size_t i) const;
 
+    /// <summary>
+    /// Value at index i without bounds check
+    /// </summary>
+    const unit value_at(const size_t i) const
+    {
+      return m_begin + m_step * (unit)i;
+    }
+
     int search(const float value) const;
     static int search(const unit begin, const unit step, const unit end, const float value);
 
@@ -35,6 +43,34 @@ namespace dynamic_programming {
     int search_away_from_zero(const float value) const;
     static int search_away_from_zero(const unit begin, const unit step, const unit end, const float value);
 
+    /// <summary>
+    /// Same result as search(const float) for integral values, without float conversion and rounding.
+    /// Step must be equal to the step of the range. For Step == 1 the index is just value - begin.
+    /// </summary>
+    template <unit Step>
+    int search_integral(const unit value) const
+    {
+      static_assert(Step > 0, "Step must be greater than 0");
+      unit offset = value - m_begin;
+      int index;
+      if constexpr (Step == 1)
+        index = offset;
+      else
+        index = value > 0 ? (offset + Step - 1) / Step : offset / Step;
+      bool inside = (unsigned)offset <= (unsigned)(m_end - m_begin);
+      return inside ? index : -1;
+    }
+
+    /// <summary>
+    /// Batched search_integral. The loop has no branches so that the compiler can vectorize it.
+    /// </summary>
+    template <unit Step>
+    void search_integral(const unit* values, int* indices, const size_t count) const
+    {
+      for (size_t i = 0; i < count; i++)
+        indices[i] = search_integral<Step>(values[i]);
+    }
+
     size_t length() const;
 
     std::string to_string() const;
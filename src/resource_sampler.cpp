@@ -0,0 +1,73 @@
+#include "resource_sampler.h"
+
+dynamic_programming::ResourceSampler::ResourceSampler(const std::chrono::milliseconds& interval)
+  : m_interval(interval), m_begin(std::chrono::steady_clock::now())
+{
+  if (interval.count() <= 0)
+    throw std::invalid_argument("Sample interval must be greater than 0");
+}
+
+dynamic_programming::ResourceSampler::~ResourceSampler()
+{
+  stop();
+}
+
+void dynamic_programming::ResourceSampler::start()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_running)
+    return;
+  m_running = true;
+  m_thread = std::thread(&ResourceSampler::run, this);
+}
+
+void dynamic_programming::ResourceSampler::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running)
+      return;
+    m_running = false;
+  }
+  m_condition.notify_all();
+  m_thread.join();
+}
+
+void dynamic_programming::ResourceSampler::set_tag(const std::string& phase, const long stage)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_phase = phase;
+  m_stage = stage;
+  if (m_running)
+    sample();
+}
+
+std::vector<dynamic_programming::ResourceSampler::Sample> dynamic_programming::ResourceSampler::take_samples()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<Sample> samples;
+  samples.swap(m_samples);
+  return samples;
+}
+
+void dynamic_programming::ResourceSampler::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (m_running)
+  {
+    sample();
+    m_condition.wait_for(lock, m_interval, [this]() { return !m_running; });
+  }
+}
+
+void dynamic_programming::ResourceSampler::sample()
+{
+  // Called with m_mutex locked
+  m_samples.push_back(Sample
+    {
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_begin),
+      m_phase,
+      m_stage,
+      get_resource_usage()
+    });
+}
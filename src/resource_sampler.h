@@ -0,0 +1,65 @@
+#pragma once
+
+#include "process_stats.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Samples the resource usage of the process in a background thread at a fixed interval.
+  /// Every sample is tagged with the phase and stage that were set last, e.g. ("stage", 27).
+  /// </summary>
+  class ResourceSampler
+  {
+  public:
+    struct Sample
+    {
+      std::chrono::milliseconds time;
+      std::string phase;
+      long stage;
+      ResourceUsage usage;
+    };
+
+    ResourceSampler(const std::chrono::milliseconds& interval);
+    ~ResourceSampler();
+
+    // Delete copy constructor and assignment operator
+    ResourceSampler(ResourceSampler const&) = delete;
+    void operator=(ResourceSampler const&) = delete;
+
+    void start();
+
+    void stop();
+
+    /// <summary>
+    /// Sets the tag of the following samples. A sample is taken immediately, so that short phases get at least one.
+    /// </summary>
+    void set_tag(const std::string& phase, const long stage);
+
+    /// <summary>
+    /// Returns the samples taken so far and removes them from the sampler.
+    /// </summary>
+    std::vector<Sample> take_samples();
+
+  private:
+    void run();
+
+    void sample();
+
+    const std::chrono::milliseconds m_interval;
+    const std::chrono::steady_clock::time_point m_begin;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_running = false;
+    std::string m_phase = "idle";
+    long m_stage = -1;
+    std::vector<Sample> m_samples;
+  };
+}
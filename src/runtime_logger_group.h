@@ -0,0 +1,48 @@
+#pragma once
+
+#include "dynamic_programming.h"
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Forwards every event of the DP to a list of runtime loggers, so that more than one can be attached.
+  /// The loggers are not owned and must outlive the group.
+  /// </summary>
+  class RuntimeLoggerGroup : public DynamicProgramming::RuntimeLogger
+  {
+  public:
+    void add(DynamicProgramming::RuntimeLogger* logger)
+    {
+      if (logger != nullptr)
+        m_loggers.push_back(logger);
+    }
+
+    void dp_started(const DpStartedEvent& event) override
+    {
+      for (DynamicProgramming::RuntimeLogger* logger : m_loggers)
+        logger->dp_started(event);
+    }
+
+    void dp_finished(const DpFinishedEvent& event) override
+    {
+      for (DynamicProgramming::RuntimeLogger* logger : m_loggers)
+        logger->dp_finished(event);
+    }
+
+    void dp_phase_started(const DpPhaseStartedEvent& event) override
+    {
+      for (DynamicProgramming::RuntimeLogger* logger : m_loggers)
+        logger->dp_phase_started(event);
+    }
+
+    void dp_stage_finished(const DpStageFinishedEvent& event) override
+    {
+      for (DynamicProgramming::RuntimeLogger* logger : m_loggers)
+        logger->dp_stage_finished(event);
+    }
+
+  private:
+    std::vector<DynamicProgramming::RuntimeLogger*> m_loggers;
+  };
+}
@@ -0,0 +1,133 @@
+#include "scaling_benchmark.h"
+
+dynamic_programming::ScalingBenchmark::ScalingBenchmark(const Settings& settings, const int grid_length, const int repetitions, const int max_threads)
+  : m_settings(settings), m_grid_length(grid_length), m_repetitions(repetitions), m_max_threads(max_threads)
+{
+  if (grid_length < 5)
+    throw std::invalid_argument("Grid length of the scaling benchmark must be at least 5");
+  if (repetitions < 1)
+    throw std::invalid_argument("Scaling benchmark needs at least one repetition");
+  if (max_threads < 1)
+    throw std::invalid_argument("Scaling benchmark needs at least one thread");
+}
+
+void dynamic_programming::ScalingBenchmark::run_all()
+{
+  m_results.clear();
+  std::vector<int> thread_counts = get_thread_counts();
+
+  // Strong scaling: same problem for all thread counts
+  size_t first = m_results.size();
+  for (int threads : thread_counts)
+  {
+    Result result = measure("strong", threads, m_grid_length);
+    result.speedup = m_results.size() == first ? 1. : m_results[first].stage_sweep_ms / result.stage_sweep_ms;
+    result.efficiency = result.speedup / threads;
+    m_results.push_back(result);
+  }
+
+  // Weak scaling: the first position axis grows with the number of threads
+  first = m_results.size();
+  for (int threads : thread_counts)
+  {
+    Result result = measure("weak", threads, m_grid_length * threads);
+    // Speedup is the work done per time compared to one thread
+    result.speedup = m_results.size() == first ? 1. : threads * m_results[first].stage_sweep_ms / result.stage_sweep_ms;
+    result.efficiency = result.speedup / threads;
+    m_results.push_back(result);
+  }
+}
+
+void dynamic_programming::ScalingBenchmark::write_csv(const std::string& path) const
+{
+  std::ofstream out(path);
+  if (!out.is_open())
+    throw std::invalid_argument("Could not open file " + path);
+  out << "mode,threads,states,stage_sweep_ms,speedup,efficiency,imbalance" << std::endl;
+  for (const Result& r : m_results)
+    out << r.mode << "," << r.threads << "," << r.states << "," << r.stage_sweep_ms << "," << r.speedup << "," << r.efficiency << "," << r.imbalance << std::endl;
+}
+
+void dynamic_programming::ScalingBenchmark::dp_stage_finished(const DpStageFinishedEvent& event)
+{
+  m_stage_sweep += event.duration;
+  std::chrono::nanoseconds busy_max{ 0 };
+  std::chrono::nanoseconds busy_sum{ 0 };
+  for (const std::chrono::nanoseconds& busy : event.thread_busy)
+  {
+    busy_max = std::max(busy_max, busy);
+    busy_sum += busy;
+  }
+  if (busy_sum.count() > 0)
+    m_imbalance_sum += (double)busy_max.count() * event.thread_busy.size() / busy_sum.count();
+  else
+    m_imbalance_sum += 1.;
+  m_stages++;
+}
+
+dynamic_programming::ScalingBenchmark::Result dynamic_programming::ScalingBenchmark::measure(const std::string& mode, const int threads, const int length_c1)
+{
+  Settings settings = m_settings;
+  settings.number_of_stages = NUM_STAGES;
+  settings.max_number_of_stages = NUM_STAGES;
+  settings.num_threads = threads;
+  settings.enable_norm_fix_point = false;
+  settings.enable_initial_fix_point = false;
+  settings.perf_counters = false;
+
+  ObstacleWorld world(std::vector<unit3>{});
+  StateSpace state_space = get_state_space(length_c1);
+  StateSpace goal_space
+  {
+    { -1, -1, -1, -1, -1, -1 },
+    { STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE },
+    { 1, 1, 1, 1, 1, 1 }
+  };
+  DynamicProgramming dp(state_space, goal_space, DELTA_TIME, unit3::ONE(), unit3::ZERO(), world, settings, this);
+
+  size_t states = 1;
+  for (int i = 0; i < 6; i++)
+    states *= state_space.get_range(i).length();
+
+  float x0[6]{ (float)state_space.begin[0], (float)state_space.begin[1], (float)state_space.begin[2], 0.f, 0.f, 0.f };
+
+  // The first run is a warm up and isn't recorded
+  for (int i = -1; i < m_repetitions; i++)
+  {
+    if (i == 0)
+    {
+      m_stage_sweep = std::chrono::nanoseconds(0);
+      m_imbalance_sum = 0.;
+      m_stages = 0;
+    }
+    dp.calculate_controller(x0);
+  }
+
+  Result result{ mode, threads, states, 0., 0., 0., 1. };
+  result.stage_sweep_ms = std::chrono::duration<double, std::milli>(m_stage_sweep).count() / m_repetitions;
+  if (m_stages > 0)
+    result.imbalance = m_imbalance_sum / m_stages;
+  BOOST_LOG_TRIVIAL(info) << "Scaling benchmark (" << mode << "): " << threads << " threads, " << states << " states, stage sweep "
+    << result.stage_sweep_ms << " ms, imbalance " << result.imbalance;
+  return result;
+}
+
+std::vector<int> dynamic_programming::ScalingBenchmark::get_thread_counts() const
+{
+  std::vector<int> thread_counts;
+  for (int threads = 1; threads < m_max_threads; threads *= 2)
+    thread_counts.push_back(threads);
+  thread_counts.push_back(m_max_threads);
+  return thread_counts;
+}
+
+dynamic_programming::StateSpace dynamic_programming::ScalingBenchmark::get_state_space(const int length_c1) const
+{
+  const unit h = m_grid_length / 2;
+  return
+  {
+    { -h, -h, -h, -3, -3, -3 },
+    { STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE, STEP_SIZE },
+    { (unit)(-h + length_c1 - 1), h, h, 3, 3, 3 }
+  };
+}
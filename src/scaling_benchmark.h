@@ -0,0 +1,77 @@
+#pragma once
+
+#include "config.h"
+#include "consts.h"
+#include "dynamic_programming.h"
+#include "obstacle_world.h"
+#include "state_space.h"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Scaling benchmark of the stage sweep of calculate_controller on a synthetic, obstacle free state space.
+  /// Strong scaling runs the same problem with 1, 2, 4, ... up to max_threads threads. Weak scaling grows the first
+  /// position axis with the number of threads, so that the work per thread stays the same. Both report the mean
+  /// duration of the stage sweep, the speedup and parallel efficiency relative to one thread, and the imbalance of
+  /// the threads (maximum over mean busy time, averaged over the stages).
+  /// </summary>
+  class ScalingBenchmark : public DynamicProgramming::RuntimeLogger
+  {
+  public:
+    struct Result
+    {
+      std::string mode;
+      int threads;
+      size_t states;
+      double stage_sweep_ms;
+      double speedup;
+      double efficiency;
+      double imbalance;
+    };
+
+    ScalingBenchmark(const Settings& settings, const int grid_length, const int repetitions, const int max_threads);
+
+    void run_all();
+
+    void write_csv(const std::string& path) const;
+
+    const std::vector<Result>& get_results() const { return m_results; }
+
+    void dp_started(const DpStartedEvent& event) override { (void)event; }
+
+    void dp_finished(const DpFinishedEvent& event) override { (void)event; }
+
+    void dp_stage_finished(const DpStageFinishedEvent& event) override;
+
+  private:
+    /// <summary>
+    /// Number of stages of every DP. The fix points are disabled, so that all of them are calculated.
+    /// </summary>
+    static const int NUM_STAGES = 4;
+
+    /// <summary>
+    /// Runs calculate_controller `repetitions` times after one warm up and returns the result without speedup and efficiency
+    /// </summary>
+    Result measure(const std::string& mode, const int threads, const int length_c1);
+
+    std::vector<int> get_thread_counts() const;
+
+    StateSpace get_state_space(const int length_c1) const;
+
+    const Settings m_settings;
+    const int m_grid_length;
+    const int m_repetitions;
+    const int m_max_threads;
+    std::vector<Result> m_results;
+
+    std::chrono::nanoseconds m_stage_sweep{ 0 };
+    double m_imbalance_sum = 0.;
+    size_t m_stages = 0;
+  };
+}
@@ -0,0 +1,233 @@
+#include "scenario_benchmark.h"
+#include "main.h"
+
+const std::vector<dynamic_programming::ScenarioBenchmark::MatrixEntry> dynamic_programming::ScenarioBenchmark::CONFIG_MATRIX =
+{
+  { "no_disturbance", false, true, true },
+  { "disturbance", true, true, true }
+};
+
+static const size_t MB = (size_t)1024 * 1024;
+
+/// <summary>
+/// Durations may always differ by this much, because short legs are dominated by noise
+/// </summary>
+static const long long MIN_TIME_DIFFERENCE_MS = 500;
+
+dynamic_programming::ScenarioBenchmark::ScenarioBenchmark(const Settings& settings, const std::string& scenario_directory, const std::vector<std::string>& scenarios, const std::vector<std::string>& configs)
+  : m_settings(settings), m_scenario_directory(scenario_directory), m_scenarios(scenarios)
+{
+  for (const std::string& config : configs)
+  {
+    auto it = std::find_if(CONFIG_MATRIX.begin(), CONFIG_MATRIX.end(), [&](const MatrixEntry& entry) { return entry.name == config; });
+    if (it == CONFIG_MATRIX.end())
+      throw std::invalid_argument("Unknown benchmark config " + config);
+    m_matrix.push_back(*it);
+  }
+  if (m_scenarios.empty() || m_matrix.empty())
+    throw std::invalid_argument("Scenario benchmark needs at least one scenario and one config");
+}
+
+void dynamic_programming::ScenarioBenchmark::run_all()
+{
+  m_rows.clear();
+  m_peak_rss_per_leg = reset_peak_rss();
+  if (!m_peak_rss_per_leg)
+    BOOST_LOG_TRIVIAL(warning) << "Benchmark: the peak RSS can't be reset on this platform, so the memory of the legs isn't compared";
+  for (const std::string& scenario : m_scenarios)
+    for (const MatrixEntry& entry : m_matrix)
+      run(scenario, entry);
+}
+
+void dynamic_programming::ScenarioBenchmark::run(const std::string& scenario, const MatrixEntry& entry)
+{
+  // Prefer the binary scenario file if it has been generated
+  std::string directory = m_scenario_directory + "/" + scenario + "/";
+  std::string route_file = directory + scenario + ".route";
+  std::string collisions_file = directory + scenario + ".collisions";
+  if (std::filesystem::exists(directory + scenario + ".scenario"))
+    route_file = collisions_file = directory + scenario + ".scenario";
+
+  Settings settings = m_settings;
+  settings.disturbance_on = entry.disturbance_on;
+  settings.enable_norm_fix_point = entry.enable_norm_fix_point;
+  settings.enable_initial_fix_point = entry.enable_initial_fix_point;
+  if (settings.random_seed == 0)
+    settings.random_seed = DEFAULT_SEED;
+
+  m_current_scenario = scenario;
+  m_current_config = entry.name;
+  m_current_state = "Starting";
+  m_current_leg = 0;
+
+  BOOST_LOG_TRIVIAL(info) << "Benchmark: running scenario " << scenario << " with config " << entry.name;
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  try
+  {
+    std::vector<unit3> route = get_route(route_file);
+    ObstacleWorld world(collisions_file);
+    HybridAutomaton hybrid_automaton(route, world, settings, this);
+    hybrid_automaton.addEventListener(this);
+    hybrid_automaton.run_until_end();
+    hybrid_automaton.removeEventListener(this);
+  }
+  catch (const std::exception& e)
+  {
+    BOOST_LOG_TRIVIAL(error) << "Benchmark: scenario " << scenario << " with config " << entry.name << " failed: " << e.what();
+    m_rows.push_back(Row{ scenario, entry.name, -1, "failed", 0, 0, 0, 0, 0, get_peak_rss() / MB });
+  }
+  BOOST_LOG_TRIVIAL(info) << "Benchmark: scenario " << scenario << " with config " << entry.name << " took "
+    << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - begin).count() << " s";
+}
+
+void dynamic_programming::ScenarioBenchmark::dp_started(const DpStartedEvent& event)
+{
+  if (!event.retry || m_rows.empty())
+  {
+    // Retries belong to the leg, so the peak is only reset when a leg begins
+    reset_peak_rss();
+    m_current_leg++;
+    m_rows.push_back(Row{ m_current_scenario, m_current_config, m_current_leg, m_current_state, 0, 0, event.num_states, 0, 0, 0 });
+  }
+  else
+  {
+    m_rows.back().retries++;
+    m_rows.back().num_states = event.num_states;
+  }
+  m_dp_begin = std::chrono::steady_clock::now();
+}
+
+void dynamic_programming::ScenarioBenchmark::dp_finished(const DpFinishedEvent& event)
+{
+  Row& row = m_rows.back();
+  row.dp_time_ms += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_dp_begin).count();
+  row.stages += event.num_stages;
+  row.finite_states = event.finite_states;
+  row.peak_rss_mb = get_peak_rss() / MB;
+}
+
+void dynamic_programming::ScenarioBenchmark::on_state_changed(const HybridAutomaton::StateChangedEvent& event)
+{
+  m_current_state = event.new_state->name();
+}
+
+void dynamic_programming::ScenarioBenchmark::write_csv(const std::string& path) const
+{
+  std::ofstream out(path);
+  if (!out.is_open())
+    throw std::invalid_argument("Could not open file " + path);
+  out << "scenario,config,leg,state,dp_time_ms,stages,num_states,finite_states,retries,peak_rss_mb" << std::endl;
+  for (const Row& row : m_rows)
+  {
+    out << row.scenario << "," << row.config << "," << row.leg << "," << row.state << "," << row.dp_time_ms << ","
+      << row.stages << "," << row.num_states << "," << row.finite_states << "," << row.retries << "," << row.peak_rss_mb << std::endl;
+  }
+}
+
+bool dynamic_programming::ScenarioBenchmark::compare_with_baseline(const std::string& path, const float tolerance) const
+{
+  if (!std::filesystem::exists(path))
+  {
+    BOOST_LOG_TRIVIAL(error) << "Benchmark: no baseline at " << path << ". Write one with benchmark_baseline_mode=write or skip the comparison with benchmark_baseline_mode=skip.";
+    return false;
+  }
+
+  std::map<std::string, Row> baseline;
+  for (const Row& row : read_csv(path))
+    baseline[key(row)] = row;
+
+  bool passed = true;
+  for (const Row& row : m_rows)
+  {
+    auto it = baseline.find(key(row));
+    if (it == baseline.end())
+    {
+      BOOST_LOG_TRIVIAL(warning) << "Benchmark: " << key(row) << " is not in the baseline";
+      continue;
+    }
+    const Row& base = it->second;
+    if (row.state != base.state || row.stages != base.stages || row.num_states != base.num_states
+      || row.finite_states != base.finite_states || row.retries != base.retries)
+    {
+      BOOST_LOG_TRIVIAL(error) << "Benchmark: " << key(row) << " differs from the baseline (stages " << row.stages << " vs " << base.stages
+        << ", num_states " << row.num_states << " vs " << base.num_states << ", finite_states " << row.finite_states << " vs " << base.finite_states
+        << ", retries " << row.retries << " vs " << base.retries << ")";
+      passed = false;
+    }
+    if (row.dp_time_ms > std::max((long long)(base.dp_time_ms * (1.f + tolerance)), base.dp_time_ms + MIN_TIME_DIFFERENCE_MS))
+    {
+      BOOST_LOG_TRIVIAL(error) << "Benchmark: " << key(row) << " is slower than the baseline (" << row.dp_time_ms << " ms vs " << base.dp_time_ms << " ms)";
+      passed = false;
+    }
+    if (m_peak_rss_per_leg && row.peak_rss_mb > base.peak_rss_mb * (1.f + tolerance))
+    {
+      BOOST_LOG_TRIVIAL(error) << "Benchmark: " << key(row) << " needs more memory than the baseline (" << row.peak_rss_mb << " MB vs " << base.peak_rss_mb << " MB)";
+      passed = false;
+    }
+    baseline.erase(it);
+  }
+
+  // Legs of the benchmarked scenarios and configs that disappeared
+  for (const auto& pair : baseline)
+  {
+    bool benchmarked = std::any_of(m_rows.begin(), m_rows.end(), [&](const Row& row) { return row.scenario == pair.second.scenario && row.config == pair.second.config; });
+    if (benchmarked)
+    {
+      BOOST_LOG_TRIVIAL(error) << "Benchmark: " << pair.first << " is missing compared to the baseline";
+      passed = false;
+    }
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "Benchmark: comparison with " << path << (passed ? " passed" : " failed");
+  return passed;
+}
+
+std::vector<std::string> dynamic_programming::ScenarioBenchmark::split(const std::string& list)
+{
+  std::vector<std::string> result;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ','))
+    if (!item.empty())
+      result.push_back(item);
+  return result;
+}
+
+std::vector<dynamic_programming::ScenarioBenchmark::Row> dynamic_programming::ScenarioBenchmark::read_csv(const std::string& path)
+{
+  std::ifstream in(path);
+  if (!in.is_open())
+    throw std::invalid_argument("Could not open file " + path);
+
+  std::vector<Row> rows;
+  std::string line;
+  // Skip header
+  std::getline(in, line);
+  while (std::getline(in, line))
+  {
+    if (line.empty())
+      continue;
+    std::vector<std::string> values = split(line);
+    if (values.size() != 10)
+      throw std::invalid_argument("Invalid line in benchmark baseline " + path + ": " + line);
+    rows.push_back(Row
+      {
+        values[0],
+        values[1],
+        std::stoi(values[2]),
+        values[3],
+        std::stoll(values[4]),
+        std::stoull(values[5]),
+        std::stoull(values[6]),
+        std::stoull(values[7]),
+        std::stoi(values[8]),
+        std::stoull(values[9])
+      });
+  }
+  return rows;
+}
+
+std::string dynamic_programming::ScenarioBenchmark::key(const Row& row)
+{
+  return row.scenario + "/" + row.config + "/" + std::to_string(row.leg);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "config.h"
+#include "consts.h"
+#include "dynamic_programming.h"
+#include "hybrid_automaton.h"
+#include "obstacle_world.h"
+#include "process_stats.h"
+#include <boost/log/trivial.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Headless regression benchmark. Runs every route of a list of scenarios end to end for every entry of a fixed
+  /// config matrix, without logger and plotter, and records one row per leg (one leg per controller that is
+  /// calculated, retries included). The rows are written to a CSV file and compared against a baseline CSV.
+  /// Durations and the peak RSS may exceed the baseline by the tolerance, everything else has to be equal.
+  /// The peak RSS of a leg is measured from its beginning, if the platform can reset the peak.
+  /// </summary>
+  class ScenarioBenchmark : public DynamicProgramming::RuntimeLogger, public HybridAutomaton::EventListener
+  {
+  public:
+    /// <summary>
+    /// Entry of the config matrix. It overrides the corresponding values of the settings.
+    /// </summary>
+    struct MatrixEntry
+    {
+      std::string name;
+      bool disturbance_on;
+      bool enable_norm_fix_point;
+      bool enable_initial_fix_point;
+    };
+
+    struct Row
+    {
+      std::string scenario;
+      std::string config;
+      int leg;
+      std::string state;
+      long long dp_time_ms;
+      size_t stages;
+      size_t num_states;
+      size_t finite_states;
+      int retries;
+      size_t peak_rss_mb;
+    };
+
+    static const std::vector<MatrixEntry> CONFIG_MATRIX;
+
+    /// <summary>
+    /// Seed of the disturbances if the settings don't fix one
+    /// </summary>
+    static const int DEFAULT_SEED = 1;
+
+    ScenarioBenchmark(const Settings& settings, const std::string& scenario_directory, const std::vector<std::string>& scenarios, const std::vector<std::string>& configs);
+
+    void run_all();
+
+    void write_csv(const std::string& path) const;
+
+    /// <summary>
+    /// Compares the rows with the baseline CSV file.
+    /// Returns false if a row regressed or differs from the baseline.
+    /// </summary>
+    bool compare_with_baseline(const std::string& path, const float tolerance) const;
+
+    void dp_started(const DpStartedEvent& event) override;
+
+    void dp_finished(const DpFinishedEvent& event) override;
+
+    void on_state_changed(const HybridAutomaton::StateChangedEvent& event) override;
+
+    void on_x_changed(const HybridAutomaton::XChangedEvent& event) override { (void)event; }
+
+    static std::vector<std::string> split(const std::string& list);
+
+  private:
+    void run(const std::string& scenario, const MatrixEntry& entry);
+
+    static std::vector<Row> read_csv(const std::string& path);
+
+    static std::string key(const Row& row);
+
+    const Settings m_settings;
+    const std::string m_scenario_directory;
+    const std::vector<std::string> m_scenarios;
+    std::vector<MatrixEntry> m_matrix;
+    std::vector<Row> m_rows;
+
+    std::string m_current_scenario;
+    std::string m_current_config;
+    std::string m_current_state;
+    int m_current_leg = 0;
+    std::chrono::steady_clock::time_point m_dp_begin;
+    bool m_peak_rss_per_leg = false;
+  };
+}
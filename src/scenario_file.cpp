@@ -0,0 +1,127 @@
+#include "scenario_file.h"
+
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char SCENARIO_MAGIC[4] = { 'D', 'P', 'S', 'C' };
+
+dynamic_programming::ScenarioFile::ScenarioFile(const std::string& path)
+{
+  map(path);
+  try
+  {
+    validate(path);
+  }
+  catch (...)
+  {
+    unmap();
+    throw;
+  }
+}
+
+dynamic_programming::ScenarioFile::~ScenarioFile()
+{
+  unmap();
+}
+
+bool dynamic_programming::ScenarioFile::is_scenario_file(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  char magic[4]{};
+  if (!file.read(magic, sizeof(magic)))
+    return false;
+  return std::memcmp(magic, SCENARIO_MAGIC, sizeof(magic)) == 0;
+}
+
+void dynamic_programming::ScenarioFile::map(const std::string& path)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::invalid_argument("Could not open file " + path);
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    throw std::invalid_argument("Could not get size of file " + path);
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL)
+  {
+    CloseHandle(file);
+    throw std::invalid_argument("Could not map file " + path);
+  }
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == NULL)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    throw std::invalid_argument("Could not map file " + path);
+  }
+  m_file_handle = file;
+  m_mapping_handle = mapping;
+  m_data = static_cast<const unsigned char*>(data);
+  m_size = (size_t)size.QuadPart;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::invalid_argument("Could not open file " + path);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    throw std::invalid_argument("Could not get size of file " + path);
+  }
+  void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the descriptor
+  close(fd);
+  if (data == MAP_FAILED)
+    throw std::invalid_argument("Could not map file " + path);
+  m_data = static_cast<const unsigned char*>(data);
+  m_size = (size_t)st.st_size;
+#endif
+}
+
+void dynamic_programming::ScenarioFile::unmap()
+{
+  if (m_data == nullptr)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+  CloseHandle(m_mapping_handle);
+  CloseHandle(m_file_handle);
+  m_mapping_handle = nullptr;
+  m_file_handle = nullptr;
+#else
+  munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void dynamic_programming::ScenarioFile::validate(const std::string& path)
+{
+  if (m_size < sizeof(Header))
+    throw std::invalid_argument("Scenario file " + path + " is too small");
+  m_header = reinterpret_cast<const Header*>(m_data);
+  if (std::memcmp(m_header->magic, SCENARIO_MAGIC, sizeof(SCENARIO_MAGIC)) != 0)
+    throw std::invalid_argument("File " + path + " is not a scenario file");
+  if (m_header->version != VERSION)
+    throw std::invalid_argument("Scenario file " + path + " has unsupported version " + std::to_string(m_header->version));
+
+  // Check that all arrays lie inside the file
+  size_t point_size = (m_header->flags & FLAG_INT16_POINTS) ? sizeof(int16_t) : sizeof(int32_t);
+  auto fits = [this](uint64_t offset, uint64_t bytes) { return offset <= m_size && bytes <= m_size - offset; };
+  if (!fits(m_header->points_offset, m_header->num_points * 3 * point_size))
+    throw std::invalid_argument("Obstacle points of scenario file " + path + " exceed the file");
+  if (!fits(m_header->route_offset, m_header->num_route_points * 3 * sizeof(int32_t)))
+    throw std::invalid_argument("Route points of scenario file " + path + " exceed the file");
+  m_points = m_data + m_header->points_offset;
+  m_route = m_data + m_header->route_offset;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "consts.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Read only, memory mapped binary scenario file.
+  /// Points are decoded straight from the mapping, so reading a scenario doesn't allocate per point.
+  /// Files are written by scenarios/scenario_to_binary.py. All values are little-endian.
+  ///
+  /// Layout:
+  /// Header
+  /// obstacle points (num_points * 3 * int16 or int32, see FLAG_INT16_POINTS)
+  /// route points (num_route_points * 3 * int32)
+  /// </summary>
+  class ScenarioFile
+  {
+  public:
+    static const uint32_t VERSION = 1;
+
+    static const uint32_t FLAG_INT16_POINTS = 1u << 0;
+
+#pragma pack(push, 1)
+    struct Header
+    {
+      char magic[4];
+      uint32_t version;
+      uint32_t flags;
+      uint32_t reserved;
+      int32_t bounds_min[3];
+      int32_t bounds_max[3];
+      uint64_t num_points;
+      uint64_t num_route_points;
+      uint64_t points_offset;
+      uint64_t route_offset;
+    };
+#pragma pack(pop)
+
+    ScenarioFile(const std::string& path);
+    ~ScenarioFile();
+
+    // Delete copy constructor and assignment operator
+    ScenarioFile(ScenarioFile const&) = delete;
+    void operator=(ScenarioFile const&) = delete;
+
+    static bool is_scenario_file(const std::string& path);
+
+    size_t num_points() const { return (size_t)m_header->num_points; }
+
+    unit3 point(const size_t i) const
+    {
+      if (m_header->flags & FLAG_INT16_POINTS)
+        return unit3(read<int16_t>(m_points, 3 * i), read<int16_t>(m_points, 3 * i + 1), read<int16_t>(m_points, 3 * i + 2));
+      return unit3(read<int32_t>(m_points, 3 * i), read<int32_t>(m_points, 3 * i + 1), read<int32_t>(m_points, 3 * i + 2));
+    }
+
+    size_t num_route_points() const { return (size_t)m_header->num_route_points; }
+
+    unit3 route_point(const size_t i) const
+    {
+      return unit3(read<int32_t>(m_route, 3 * i), read<int32_t>(m_route, 3 * i + 1), read<int32_t>(m_route, 3 * i + 2));
+    }
+
+    unit3 bounds_min() const { return unit3(m_header->bounds_min[0], m_header->bounds_min[1], m_header->bounds_min[2]); }
+    unit3 bounds_max() const { return unit3(m_header->bounds_max[0], m_header->bounds_max[1], m_header->bounds_max[2]); }
+
+  private:
+    template <typename T>
+    static T read(const unsigned char* base, const size_t index)
+    {
+      // memcpy because the mapping gives no alignment guarantees for the packed arrays
+      T value;
+      std::memcpy(&value, base + index * sizeof(T), sizeof(T));
+      return value;
+    }
+
+    void map(const std::string& path);
+    void unmap();
+    void validate(const std::string& path);
+
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    const Header* m_header = nullptr;
+    const unsigned char* m_points = nullptr;
+    const unsigned char* m_route = nullptr;
+#ifdef _WIN32
+    void* m_file_handle = nullptr;
+    void* m_mapping_handle = nullptr;
+#endif
+  };
+}
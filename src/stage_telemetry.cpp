@@ -0,0 +1,140 @@
+#include "stage_telemetry.h"
+
+static double to_ms(const std::chrono::nanoseconds& duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void dynamic_programming::StageTelemetrySink::dp_started(const DpStartedEvent& event)
+{
+  if (!event.retry)
+  {
+    m_dp_counter++;
+    m_retry = 0;
+  }
+  else
+  {
+    m_retry++;
+  }
+}
+
+void dynamic_programming::StageTelemetrySink::dp_stage_finished(const DpStageFinishedEvent& event)
+{
+  write_record(event);
+}
+
+dynamic_programming::StageTelemetrySink::ThreadSummary dynamic_programming::StageTelemetrySink::summarize(const DpStageFinishedEvent& event)
+{
+  ThreadSummary summary{ 0., 0., 0., 1. };
+  if (event.thread_busy.empty())
+    return summary;
+
+  for (size_t i = 0; i < event.thread_busy.size(); i++)
+  {
+    summary.busy_max_ms = std::max(summary.busy_max_ms, to_ms(event.thread_busy[i]));
+    summary.busy_mean_ms += to_ms(event.thread_busy[i]);
+    summary.idle_max_ms = std::max(summary.idle_max_ms, to_ms(event.thread_idle[i]));
+  }
+  summary.busy_mean_ms /= event.thread_busy.size();
+  if (summary.busy_mean_ms > 0.)
+    summary.imbalance = summary.busy_max_ms / summary.busy_mean_ms;
+  return summary;
+}
+
+void dynamic_programming::StageTelemetrySink::write_json(std::ostream& out, const PerfCounters::Values& values)
+{
+  out << "{";
+  bool first = true;
+  for (int i = 0; i < PerfCounters::NUM_COUNTERS; i++)
+  {
+    if (!values.available((PerfCounters::Counter)i))
+      continue;
+    out << (first ? "" : ",") << "\"" << PerfCounters::COUNTER_NAMES[i] << "\":" << values.counts[i];
+    first = false;
+  }
+  if (values.ipc() >= 0.)
+    out << (first ? "" : ",") << "\"ipc\":" << values.ipc();
+  out << "}";
+}
+
+dynamic_programming::JsonLinesStageSink::JsonLinesStageSink(const std::string& directory_path)
+{
+  m_file.open(directory_path + "stage_telemetry.jsonl");
+  if (!m_file.is_open())
+    throw std::invalid_argument("Could not open file " + directory_path + "stage_telemetry.jsonl");
+}
+
+void dynamic_programming::JsonLinesStageSink::write_record(const DpStageFinishedEvent& event)
+{
+  auto write_array = [&](const std::vector<std::chrono::nanoseconds>& durations)
+    {
+      m_file << "[";
+      for (size_t i = 0; i < durations.size(); i++)
+        m_file << (i > 0 ? "," : "") << to_ms(durations[i]);
+      m_file << "]";
+    };
+
+  m_file << "{\"dp\":" << m_dp_counter
+    << ",\"retry\":" << m_retry
+    << ",\"stage\":" << event.stage
+    << ",\"duration_ms\":" << to_ms(event.duration)
+    << ",\"finite_states\":" << event.finite_states
+    << ",\"evaluated_states\":" << event.evaluated_states
+    << ",\"skipped_states\":" << event.skipped_states
+    << ",\"collision_checks\":" << event.collision_checks
+    << ",\"collision_memo_hits\":" << event.collision_memo_hits
+    << ",\"obstacles_scanned\":" << event.obstacles_scanned
+    << ",\"max_value_change\":";
+  // JSON has no infinity
+  if (std::isinf(event.max_value_change))
+    m_file << "null";
+  else
+    m_file << event.max_value_change;
+  m_file << ",\"policy_changes\":" << event.policy_changes
+    << ",\"thread_busy_ms\":";
+  write_array(event.thread_busy);
+  m_file << ",\"thread_idle_ms\":";
+  write_array(event.thread_idle);
+  m_file << ",\"perf\":";
+  write_json(m_file, event.perf);
+  m_file << ",\"thread_perf\":[";
+  for (size_t i = 0; i < event.thread_perf.size(); i++)
+  {
+    m_file << (i > 0 ? "," : "");
+    write_json(m_file, event.thread_perf[i]);
+  }
+  m_file << "]}" << std::endl;
+}
+
+dynamic_programming::CsvStageSink::CsvStageSink(const std::string& directory_path)
+{
+  m_file.open(directory_path + "stage_telemetry.csv");
+  if (!m_file.is_open())
+    throw std::invalid_argument("Could not open file " + directory_path + "stage_telemetry.csv");
+  m_file << "dp,retry,stage,duration_ms,finite_states,evaluated_states,skipped_states,collision_checks,collision_memo_hits,obstacles_scanned,max_value_change,policy_changes,"
+    << "busy_max_ms,busy_mean_ms,idle_max_ms,imbalance";
+  for (const std::string& name : PerfCounters::COUNTER_NAMES)
+    m_file << "," << name;
+  m_file << ",ipc" << std::endl;
+}
+
+void dynamic_programming::CsvStageSink::write_record(const DpStageFinishedEvent& event)
+{
+  ThreadSummary summary = summarize(event);
+  m_file << m_dp_counter << "," << m_retry << "," << event.stage << "," << to_ms(event.duration) << ","
+    << event.finite_states << "," << event.evaluated_states << "," << event.skipped_states << ","
+    << event.collision_checks << "," << event.collision_memo_hits << "," << event.obstacles_scanned << ","
+    << event.max_value_change << "," << event.policy_changes << ","
+    << summary.busy_max_ms << "," << summary.busy_mean_ms << "," << summary.idle_max_ms << "," << summary.imbalance;
+  // Unavailable counters are left empty
+  for (int i = 0; i < PerfCounters::NUM_COUNTERS; i++)
+  {
+    m_file << ",";
+    if (event.perf.available((PerfCounters::Counter)i))
+      m_file << event.perf.counts[i];
+  }
+  m_file << ",";
+  if (event.perf.ipc() >= 0.)
+    m_file << event.perf.ipc();
+  m_file << std::endl;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "dynamic_programming.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace dynamic_programming
+{
+  /// <summary>
+  /// Writes one record per DP stage. Records are keyed by the number of the DP, the retry within that DP and the stage,
+  /// so that the output of a run can be joined with dp_stats.txt and dp_phases.csv.
+  /// </summary>
+  class StageTelemetrySink : public DynamicProgramming::RuntimeLogger
+  {
+  public:
+    void dp_started(const DpStartedEvent& event) override;
+
+    void dp_finished(const DpFinishedEvent& event) override { (void)event; }
+
+    void dp_stage_finished(const DpStageFinishedEvent& event) override;
+
+  protected:
+    /// <summary>
+    /// Thread time summary of one stage
+    /// </summary>
+    struct ThreadSummary
+    {
+      double busy_max_ms;
+      double busy_mean_ms;
+      double idle_max_ms;
+      /// <summary>
+      /// Maximum over mean busy time. 1 means the work was perfectly balanced.
+      /// </summary>
+      double imbalance;
+    };
+
+    static ThreadSummary summarize(const DpStageFinishedEvent& event);
+
+    /// <summary>
+    /// Writes the available counters and the IPC as JSON object members
+    /// </summary>
+    static void write_json(std::ostream& out, const PerfCounters::Values& values);
+
+    virtual void write_record(const DpStageFinishedEvent& event) = 0;
+
+    int m_dp_counter = 0;
+    int m_retry = 0;
+  };
+
+  /// <summary>
+  /// Writes stage_telemetry.jsonl with one JSON object per stage, including the busy and idle time of every thread
+  /// </summary>
+  class JsonLinesStageSink : public StageTelemetrySink
+  {
+  public:
+    JsonLinesStageSink(const std::string& directory_path);
+
+  protected:
+    void write_record(const DpStageFinishedEvent& event) override;
+
+  private:
+    std::ofstream m_file;
+  };
+
+  /// <summary>
+  /// Writes stage_telemetry.csv with one row per stage. Thread times are summarized.
+  /// </summary>
+  class CsvStageSink : public StageTelemetrySink
+  {
+  public:
+    CsvStageSink(const std::string& directory_path);
+
+  protected:
+    void write_record(const DpStageFinishedEvent& event) override;
+
+  private:
+    std::ofstream m_file;
+  };
+}
@@ -0,0 +1,131 @@
+#include "tracer.h"
+
+static thread_local int t_lane = -1;
+
+static std::string escape(const std::string& s)
+{
+  std::string result;
+  for (char c : s)
+  {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+dynamic_programming::Tracer::Args& dynamic_programming::Tracer::Args::add(const std::string& key, const long long value)
+{
+  m_json += (m_json.empty() ? "\"" : ",\"") + escape(key) + "\":" + std::to_string(value);
+  return *this;
+}
+
+dynamic_programming::Tracer::Args& dynamic_programming::Tracer::Args::add(const std::string& key, const std::string& value)
+{
+  m_json += (m_json.empty() ? "\"" : ",\"") + escape(key) + "\":\"" + escape(value) + "\"";
+  return *this;
+}
+
+void dynamic_programming::Tracer::start()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_events.clear();
+  m_begin = std::chrono::steady_clock::now();
+  m_enabled = true;
+}
+
+void dynamic_programming::Tracer::stop()
+{
+  m_enabled = false;
+}
+
+void dynamic_programming::Tracer::set_thread_lane(const int lane, const std::string& name)
+{
+  t_lane = lane;
+  if (!enabled())
+    return;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_lane_names[lane] = name;
+}
+
+void dynamic_programming::Tracer::complete(const std::string& name, const std::string& category, const std::chrono::steady_clock::time_point& begin, const Args& args)
+{
+  if (!enabled())
+    return;
+  double begin_us = to_us(begin);
+  double end_us = to_us(std::chrono::steady_clock::now());
+  int lane = get_lane();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_events.push_back(Event{ name, category, 'X', begin_us, end_us - begin_us, lane, args.str() });
+}
+
+void dynamic_programming::Tracer::instant(const std::string& name, const std::string& category, const Args& args)
+{
+  if (!enabled())
+    return;
+  double now_us = to_us(std::chrono::steady_clock::now());
+  int lane = get_lane();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_events.push_back(Event{ name, category, 'i', now_us, 0., lane, args.str() });
+}
+
+void dynamic_programming::Tracer::write(const std::string& path) const
+{
+  std::ofstream out(path);
+  if (!out.is_open())
+    throw std::invalid_argument("Could not open file " + path);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+  bool first = true;
+  for (const auto& pair : m_lane_names)
+  {
+    out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pair.first
+      << ",\"args\":{\"name\":\"" << escape(pair.second) << "\"}}";
+    first = false;
+  }
+  out << std::fixed;
+  out.precision(3);
+  for (const Event& event : m_events)
+  {
+    out << (first ? "" : ",\n") << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\"" << escape(event.category)
+      << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp_us;
+    if (event.phase == 'X')
+      out << ",\"dur\":" << event.duration_us;
+    else
+      out << ",\"s\":\"t\"";
+    out << ",\"pid\":1,\"tid\":" << event.lane << ",\"args\":{" << event.args << "}}";
+    first = false;
+  }
+  out << std::endl << "]}" << std::endl;
+}
+
+int dynamic_programming::Tracer::get_lane()
+{
+  // Threads without a lane get a unique one
+  if (t_lane < 0)
+    t_lane = m_next_lane++;
+  return t_lane;
+}
+
+double dynamic_programming::Tracer::to_us(const std::chrono::steady_clock::time_point& time) const
+{
+  return std::chrono::duration<double, std::micro>(time - m_begin).count();
+}
+
+dynamic_programming::TraceSpan::TraceSpan(const std::string& name, const std::string& category, const Tracer::Args& args)
+  : m_enabled(Tracer::get_instance().enabled())
+{
+  if (!m_enabled)
+    return;
+  m_name = name;
+  m_category = category;
+  m_args = args;
+  m_begin = std::chrono::steady_clock::now();
+}
+
+dynamic_programming::TraceSpan::~TraceSpan()
+{
+  if (m_enabled)
+    Tracer::get_instance().complete(m_name, m_category, m_begin, m_args);
+}
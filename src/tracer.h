@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dynamic_programming
+{
+  // Singleton
+  /// <summary>
+  /// Collects spans and instant events and writes them in the Chrome trace event format, so that a whole run can be
+  /// opened in Perfetto or chrome://tracing. Tracing is off until start() is called, and spans cost one atomic load then.
+  /// Events are recorded with the lane of the calling thread as thread ID. The main thread is lane 0 and the worker
+  /// threads of a stage use lane 1 + their index, so that the workers of all stages share a track per index.
+  /// </summary>
+  class Tracer
+  {
+  public:
+    static Tracer& get_instance()
+    {
+      static Tracer instance;
+      return instance;
+    }
+
+    // Delete copy constructor and assignment operator
+    Tracer(Tracer const&) = delete;
+    void operator=(Tracer const&) = delete;
+
+    /// <summary>
+    /// Arguments of an event as JSON object members, e.g. "stage":27
+    /// </summary>
+    class Args
+    {
+    public:
+      Args& add(const std::string& key, const long long value);
+      Args& add(const std::string& key, const std::string& value);
+      const std::string& str() const { return m_json; }
+
+    private:
+      std::string m_json;
+    };
+
+    void start();
+
+    void stop();
+
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /// <summary>
+    /// Sets the lane of the calling thread and names its track
+    /// </summary>
+    void set_thread_lane(const int lane, const std::string& name);
+
+    /// <summary>
+    /// Records a span that started at begin and ends now
+    /// </summary>
+    void complete(const std::string& name, const std::string& category, const std::chrono::steady_clock::time_point& begin, const Args& args = Args());
+
+    void instant(const std::string& name, const std::string& category, const Args& args = Args());
+
+    /// <summary>
+    /// Writes the events recorded so far
+    /// </summary>
+    void write(const std::string& path) const;
+
+  private:
+    Tracer() = default;
+
+    struct Event
+    {
+      std::string name;
+      std::string category;
+      char phase;
+      double timestamp_us;
+      double duration_us;
+      int lane;
+      std::string args;
+    };
+
+    int get_lane();
+
+    double to_us(const std::chrono::steady_clock::time_point& time) const;
+
+    std::atomic<bool> m_enabled = false;
+    std::atomic<int> m_next_lane = 1000;
+    std::chrono::steady_clock::time_point m_begin;
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    std::map<int, std::string> m_lane_names;
+  };
+
+  /// <summary>
+  /// Records a span from construction to destruction if the tracer is enabled
+  /// </summary>
+  class TraceSpan
+  {
+  public:
+    TraceSpan(const std::string& name, const std::string& category, const Tracer::Args& args = Tracer::Args());
+    ~TraceSpan();
+
+    TraceSpan(TraceSpan const&) = delete;
+    void operator=(TraceSpan const&) = delete;
+
+  private:
+    const bool m_enabled;
+    std::string m_name;
+    std::string m_category;
+    Tracer::Args m_args;
+    std::chrono::steady_clock::time_point m_begin;
+  };
+}